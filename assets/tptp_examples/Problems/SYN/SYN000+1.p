@@ -0,0 +1,5 @@
+%------------------------------------------------------------------------------
+% File     : SYN000+1 : Transitivity through a chain of implications
+%------------------------------------------------------------------------------
+include('Axioms/SYN000-0.ax',[p_implies_q,q_implies_r]).
+fof(transitivity, conjecture, ! [Z] : ( p(Z) => r(Z) )).
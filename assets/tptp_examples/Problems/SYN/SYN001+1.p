@@ -0,0 +1,9 @@
+%------------------------------------------------------------------------------
+% File     : SYN001+1 : Witnesses named by quoted names, objects and numbers
+%------------------------------------------------------------------------------
+fof(quoted_witness, axiom, p('an apple')).
+fof(object_witness, axiom, q("an orange")).
+fof(number_witness, axiom, r(-2.5e3)).
+fof(pair_witness, axiom, s(f('it\'s'), 1/2)).
+fof(witnesses, conjecture, ( ? [X] : p(X) & ? [Y] : q(Y) & ? [Z] : r(Z) & ? [U, V] : s(U, V) )).
+%------------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "node_factory.hpp"
+#include "atom.hpp"
+#include "connective.hpp"
+#include "quantifier.hpp"
+
+static size_t allocation_count = 0;
+
+void* operator new(size_t size) {
+	allocation_count++;
+	
+	if (void* p = std::malloc(size == 0 ? 1 : size)) {
+		return p;
+	}
+	
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+// ∀ X. p0(f(X, c0)) ∧ (p1(f(X, c1)) ∧ ( ... ))
+std::shared_ptr<ForAll> build_formula(unsigned width) {
+	auto x = NodeFactory::make_variable(Symbol("X"));
+	std::shared_ptr<Formula> body = NodeFactory::make_true();
+	
+	for (unsigned i = 0; i < width; i++) {
+		auto c = NodeFactory::make_constant(Symbol("c" + std::to_string(i)));
+		auto f = NodeFactory::make_complex_term(Symbol("f"), {x, c});
+		auto atom = NodeFactory::make_complex_atom(Symbol("p" + std::to_string(i)), {f});
+		body = NodeFactory::make_conjunction(atom, body);
+	}
+	
+	return NodeFactory::make_for_all(Symbol("X"), body);
+}
+
+int main(int argc, char** argv) {
+	unsigned width = argc > 1 ? std::atoi(argv[1]) : 2000;
+	unsigned rounds = argc > 2 ? std::atoi(argv[2]) : 200;
+	
+	auto formula = build_formula(width);
+	
+	size_t allocations_before = allocation_count;
+	auto start = std::chrono::steady_clock::now();
+	
+	for (unsigned r = 0; r < rounds; r++) {
+		auto term = NodeFactory::make_complex_term(Symbol("g"), {NodeFactory::make_constant(Symbol("a" + std::to_string(r)))});
+		auto instance = formula->instantiate(term);
+		(void) instance;
+	}
+	
+	auto end = std::chrono::steady_clock::now();
+	auto ms = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+	
+	std::cout << "width: " << width << ", rounds: " << rounds << std::endl;
+	std::cout << "heap allocations: " << allocation_count - allocations_before << std::endl;
+	std::cout << "wall time: " << ms << " ms" << std::endl;
+	
+	return 0;
+}
+
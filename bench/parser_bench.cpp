@@ -0,0 +1,241 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <random>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+
+#include "formula.hpp"
+#include "fast_parser.hpp"
+#include "formula_cache.hpp"
+
+extern std::shared_ptr<Formula> parse_formula_string(const std::string& input);
+
+// p(f(X0), f(X1), ..., f(Xn-1))
+std::string build_wide_input(unsigned width) {
+	std::string input = "p(";
+	
+	for (unsigned i = 0; i < width; i++) {
+		if (i > 0) {
+			input += ", ";
+		}
+		
+		input += "f(X" + std::to_string(i) + ")";
+	}
+	
+	return input + ")";
+}
+
+// Balanced tree of connectives over 2^depth atoms.
+std::string build_large_input(unsigned depth, unsigned& counter) {
+	if (depth == 0) {
+		std::string i = std::to_string(counter++);
+		return "p" + i + "(f(X, c" + i + "), g(Y, h(Z)), k" + i + ")";
+	}
+	
+	const char* operators[] = {" & ", " | ", " => ", " <=> "};
+	
+	return "(" + build_large_input(depth - 1, counter) + operators[depth % 4] + "~" + build_large_input(depth - 1, counter) + ")";
+}
+
+// Random input that is often but not always well formed.
+class InputGenerator {
+	public:
+		std::string formula(unsigned depth) {
+			switch (depth == 0 ? 0 : pick(10)) {
+				case 0:
+				case 1:
+				case 2:
+					return atom();
+				case 3:
+					return "~" + space() + formula(depth - 1);
+				case 4:
+					return "(" + space() + formula(depth - 1) + space() + ")";
+				case 5:
+					return (pick(2) ? "!" : "?") + space() + variable() + space() + "." + space() + formula(depth - 1);
+				default: {
+					const char* operators[] = {"&", "|", "=>", "<=>"};
+					return formula(depth - 1) + space() + operators[pick(4)] + space() + formula(depth - 1);
+				}
+			}
+		}
+		
+		// Deletes, inserts or replaces one character.
+		std::string mutate(std::string input) {
+			const std::string alphabet = "()~&|=<>!?.,_ \t\r\nXYpqf0";
+			size_t position = input.empty() ? 0 : pick(input.size());
+			char c = alphabet[pick(alphabet.size())];
+			
+			switch (pick(3)) {
+				case 0:
+					if (!input.empty()) {
+						input.erase(position, 1);
+					}
+					break;
+				case 1:
+					input.insert(input.begin() + position, c);
+					break;
+				default:
+					if (!input.empty()) {
+						input[position] = c;
+					}
+			}
+			
+			return input;
+		}
+	private:
+		size_t pick(size_t n) {
+			return std::uniform_int_distribution<size_t>(0, n - 1)(_random);
+		}
+		
+		std::string space() {
+			const char* spaces[] = {"", "", " ", "\n", "\t"};
+			return spaces[pick(5)];
+		}
+		
+		std::string variable() {
+			const char* variables[] = {"X", "Y", "Z1", "True_"};
+			return variables[pick(4)];
+		}
+		
+		std::string atom() {
+			switch (pick(5)) {
+				case 0:
+					return "True";
+				case 1:
+					return "False";
+				case 2:
+					return "p";
+				default:
+					return "q(" + term(2) + (pick(2) ? "," + space() + term(2) : "") + ")";
+			}
+		}
+		
+		std::string term(unsigned depth) {
+			switch (depth == 0 ? pick(2) : pick(3)) {
+				case 0:
+					return variable();
+				case 1:
+					return "c";
+				default:
+					return "f(" + term(depth - 1) + ", " + term(depth - 1) + ")";
+			}
+		}
+	private:
+		std::mt19937 _random{42};
+};
+
+template <typename Parse>
+std::shared_ptr<Formula> try_parse(Parse parse, const std::string& input) {
+	try {
+		return parse(input);
+	} catch (const std::runtime_error&) {
+		return nullptr;
+	}
+}
+
+// Both parsers must accept the same inputs and, since equal nodes are shared,
+// return the very same node for them.
+bool differential_check(unsigned rounds) {
+	InputGenerator generator;
+	unsigned accepted = 0;
+	
+	for (unsigned i = 0; i < rounds; i++) {
+		std::string input = generator.formula(6);
+		
+		if (i % 2 == 1) {
+			input = generator.mutate(input);
+		}
+		
+		auto expected = try_parse(parse_formula_string, input);
+		auto actual = try_parse([](const std::string& s) { return fast_parse_formula(s); }, input);
+		
+		if (expected != actual) {
+			std::cout << "parsers disagree on: " << input << std::endl;
+			return false;
+		}
+		
+		if (expected) {
+			accepted++;
+		}
+	}
+	
+	std::cout << "differential check: " << rounds << " inputs, " << accepted << " accepted by both parsers" << std::endl;
+	
+	return true;
+}
+
+template <typename Parse>
+double time_parse(Parse parse, const std::string& input) {
+	auto start = std::chrono::steady_clock::now();
+	auto formula = parse(input);
+	auto end = std::chrono::steady_clock::now();
+	
+	return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+}
+
+int main(int argc, char** argv) {
+	unsigned width = argc > 1 ? std::atoi(argv[1]) : 10000;
+	unsigned steps = argc > 2 ? std::atoi(argv[2]) : 4;
+	
+	if (!differential_check(20000)) {
+		return 1;
+	}
+	
+	auto bison = [](const std::string& s) { return parse_formula_string(s); };
+	auto fast = [](const std::string& s) { return fast_parse_formula(s); };
+	
+	for (unsigned step = 0; step < steps; step++, width *= 2) {
+		std::string input = build_wide_input(width);
+		
+		// The first parse also interns the symbols and nodes, so only the
+		// later ones are timed.
+		auto formula = parse_formula_string(input);
+		
+		double bison_ms = time_parse(bison, input);
+		double fast_ms = time_parse(fast, input);
+		
+		std::cout << "arguments: " << width << ", parse time: " << bison_ms << " ms, per argument: " << bison_ms * 1000000 / width << " ns";
+		std::cout << ", recursive descent: " << fast_ms << " ms" << std::endl;
+	}
+	
+	unsigned counter = 0;
+	std::string input = build_large_input(16, counter);
+	auto formula = fast_parse_formula(input);
+	
+	double bison_ms = time_parse(bison, input);
+	double fast_ms = time_parse(fast, input);
+	double megabytes = input.size() / 1000000.0;
+	
+	std::cout << "large formula: " << megabytes << " MB, bison: " << megabytes * 1000 / bison_ms << " MB/s, recursive descent: " << megabytes * 1000 / fast_ms << " MB/s" << std::endl;
+	
+	// Loading the text and the binary image of the large formula, each time
+	// with none of its nodes alive, as in a fresh process.
+	std::string text_path = (std::filesystem::temp_directory_path() / "parser_bench.txt").string();
+	std::string cache_path = text_path + ".cache";
+	
+	std::ofstream(text_path) << input;
+	
+	CacheKey key;
+	key.source_size = input.size();
+	write_formula_cache(cache_path, formula, key);
+	formula = nullptr;
+	
+	auto file = [](const std::string& path) { return fast_parse_formula_file(path); };
+	auto cache = [&key](const std::string& path) { return read_formula_cache(path, key); };
+	
+	double cache_ms = time_parse(cache, cache_path);
+	double file_ms = time_parse(file, text_path);
+	cache_ms = time_parse(cache, cache_path);
+	file_ms = time_parse(file, text_path);
+	
+	std::cout << "large formula from file: " << file_ms << " ms, from binary cache (" << std::filesystem::file_size(cache_path) / 1000000.0 << " MB): " << cache_ms << " ms" << std::endl;
+	
+	std::remove(text_path.c_str());
+	std::remove(cache_path.c_str());
+	
+	return 0;
+}
+
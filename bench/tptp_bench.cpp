@@ -0,0 +1,104 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+
+#include "tptp_reader.hpp"
+#include "thread_pool.hpp"
+
+namespace fs = std::filesystem;
+
+// Problem files (*.p) given directly or found below the given directories.
+std::vector<std::string> collect_problems(const std::vector<std::string>& paths) {
+	std::vector<std::string> problems;
+	
+	for (const auto& path : paths) {
+		if (!fs::is_directory(path)) {
+			problems.push_back(path);
+			continue;
+		}
+		
+		for (const auto& entry : fs::recursive_directory_iterator(path)) {
+			if (entry.is_regular_file() and entry.path().extension() == ".p") {
+				problems.push_back(entry.path().string());
+			}
+		}
+	}
+	
+	std::sort(problems.begin(), problems.end());
+	
+	return problems;
+}
+
+int main(int argc, char** argv) {
+	unsigned threads = std::thread::hardware_concurrency();
+	std::vector<std::string> paths;
+	
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "-j" and i + 1 < argc) {
+			threads = std::atoi(argv[++i]);
+		} else {
+			paths.push_back(argv[i]);
+		}
+	}
+	
+	if (paths.empty()) {
+		std::cerr << "Usage: " << argv[0] << " [-j <threads>] <problem_or_directory>..." << std::endl;
+		return 1;
+	}
+	
+	std::vector<std::string> problems = collect_problems(paths);
+	
+	TptpReader reader;
+	std::mutex mutex;
+	size_t loaded = 0;
+	size_t formulas = 0;
+	size_t bytes = 0;
+	std::vector<std::string> errors;
+	
+	auto start = std::chrono::steady_clock::now();
+	
+	{
+		WorkStealingPool pool(threads);
+		
+		for (const auto& problem : problems) {
+			pool.submit([&, problem] {
+				try {
+					TptpProblem result = reader.read(problem);
+					
+					std::lock_guard<std::mutex> lock(mutex);
+					loaded++;
+					formulas += result.formulas.size();
+					bytes += result.bytes_read;
+				} catch (const std::exception& e) {
+					std::lock_guard<std::mutex> lock(mutex);
+					errors.push_back(e.what());
+				}
+			});
+		}
+		
+		pool.wait();
+		threads = pool.thread_count();
+	}
+	
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.0;
+	
+	std::sort(errors.begin(), errors.end());
+	
+	std::cout << "problems: " << problems.size() << ", loaded: " << loaded << ", not loaded: " << errors.size() << ", threads: " << threads << std::endl;
+	std::cout << "formulas: " << formulas << ", parsed: " << bytes / 1000000.0 << " MB" << std::endl;
+	std::cout << "wall time: " << seconds << " s, " << bytes / 1000000.0 / seconds << " MB/s, " << problems.size() / seconds << " problems/s" << std::endl;
+	
+	for (size_t i = 0; i < errors.size() and i < 10; i++) {
+		std::cout << "  " << errors[i] << std::endl;
+	}
+	
+	return 0;
+}
+
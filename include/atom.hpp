@@ -3,71 +3,77 @@
 #include "formula.hpp"
 
 class AtomicFormula : public Formula {
-	public:
-		virtual std::set<std::string> get_variable_names() const = 0;
-		std::set<std::string> get_free_variable_names() const override;
 	protected:
 		bool requires_parentheses() const override;
 };
 
 class LogicalConstant : public AtomicFormula {
 	public:
-		std::set<std::string> get_variable_names() const override;
+		LogicalConstant(FormulaType type);
 };
 
 class True : public LogicalConstant {
 	public:
-		std::string to_string() const override;
+		True()
+			:LogicalConstant(FormulaType::True)
+		{}
+		
+		std::string format(const BinderNames& binders) const override;
 		FormulaType type() const override;
 		bool operator==(const True& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 };
 
 class False : public LogicalConstant {
 	public:
-		std::string to_string() const override;
+		False()
+			:LogicalConstant(FormulaType::False)
+		{}
+		
+		std::string format(const BinderNames& binders) const override;
 		FormulaType type() const override;
 		bool operator==(const False& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 };
 
 class Atom : public AtomicFormula {
 	public:
-		Atom(const std::string& p)
-			:_predicate_symbol(p)
-		{}
+		Atom(FormulaType type, const Symbol& p);
+		
+		Symbol get_predicate_symbol() const;
 	protected:
-		std::string _predicate_symbol;
+		Symbol _predicate_symbol;
 };
 
 class SimpleAtom : public Atom {
 	public:
-		SimpleAtom(const std::string& p)
-			:Atom(p)
+		SimpleAtom(const Symbol& p)
+			:Atom(FormulaType::SimpleAtom, p)
 		{}
 		
-		std::string to_string() const override;
+		std::string format(const BinderNames& binders) const override;
 		FormulaType type() const override;
 		bool operator==(const SimpleAtom& other) const;
-		std::set<std::string> get_variable_names() const override;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 };
 
 class ComplexAtom : public Atom {
 	public:
-		ComplexAtom(const std::string& p, const std::vector<std::shared_ptr<Term>>& terms)
-			:Atom(p), _terms(terms)
-		{}
+		ComplexAtom(const Symbol& p, const std::vector<std::shared_ptr<Term>>& terms);
 		
-		std::string to_string() const override;
+		std::string format(const BinderNames& binders) const override;
 		FormulaType type() const override;
 		bool operator==(const ComplexAtom& other) const;
-		std::set<std::string> get_variable_names() const override;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
+		const std::vector<std::shared_ptr<Term>>& get_terms() const;
 	private:
 		std::vector<std::shared_ptr<Term>> _terms;
 };
@@ -3,26 +3,7 @@
 #include <optional>
 #include <string>
 
-enum class Rule {
-	Assumption,
-	NotI,
-	NotE,
-	ConjI,
-	ConjE,
-	DisjI1,
-	DisjI2,
-	DisjE,
-	ImpI,
-	ImpE,
-	IffI,
-	IffE,
-	AllI,
-	AllE,
-	ExI,
-	ExE,
-	Ccontr,
-	Classical
-};
+#include "rule.hpp"
 
 enum class CommandType {
 	Empty,
@@ -32,12 +13,23 @@ enum class CommandType {
 	RuleApplication,
 	Done,
 	Shift,
+	Undo,
+	Redo,
+	Checkpoint,
+	Restore,
+	Auto,
 	UnknownCommand
 };
 
 struct Command {
 	CommandType type;
 	std::optional<Rule> rule_to_apply;
+	// Checkpoint name, search depth of auto, or the inline instantiation
+	// term of allE and exI.
+	std::string argument = "";
+	// The assumption an elimination rule is applied to, as written in
+	// brackets after its name: a position counted from 1, or the assumption.
+	std::string assumption = "";
 
     static Command parse_command(const std::string&);
 };
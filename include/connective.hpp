@@ -10,14 +10,10 @@ class LogicalConnective : public Formula {
 
 class UnaryConnective : public LogicalConnective {
 	public:
-		UnaryConnective(const std::shared_ptr<Formula>& sub)
-			:_subformula(sub)
-		{}
+		UnaryConnective(FormulaType type, const std::shared_ptr<Formula>& sub);
 		
-		std::string to_string() const override;
+		std::string format(const BinderNames& binders) const override;
 		std::shared_ptr<Formula> get_subformula() const;
-		std::set<std::string> get_variable_names() const override;
-		std::set<std::string> get_free_variable_names() const override;
 	protected:
 		std::shared_ptr<Formula> _subformula;
 };
@@ -25,28 +21,25 @@ class UnaryConnective : public LogicalConnective {
 class Negation : public UnaryConnective {
 	public:
 		Negation(const std::shared_ptr<Formula>& sub)
-			:UnaryConnective(sub)
+			:UnaryConnective(FormulaType::Negation, sub)
 		{}
 		
 		FormulaType type() const override;
 		bool operator==(const Negation& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
 		std::string symbol() const override;
 };
 
 class BinaryConnective : public LogicalConnective {
 	public:
-		BinaryConnective(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r)
-			:_left_subformula(l), _right_subformula(r)
-		{}
+		BinaryConnective(FormulaType type, const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r);
 		
-		std::string to_string() const override;
+		std::string format(const BinderNames& binders) const override;
 		std::shared_ptr<Formula> get_left_subformula() const;
 		std::shared_ptr<Formula> get_right_subformula() const;
-		std::set<std::string> get_variable_names() const override;
-		std::set<std::string> get_free_variable_names() const override;
 	protected:
 		std::shared_ptr<Formula> _left_subformula;
 		std::shared_ptr<Formula> _right_subformula;
@@ -55,13 +48,14 @@ class BinaryConnective : public LogicalConnective {
 class Conjunction : public BinaryConnective {
 	public:
 		Conjunction(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r)
-			:BinaryConnective(l, r)
+			:BinaryConnective(FormulaType::Conjunction, l, r)
 		{}
 		
 		FormulaType type() const override;
 		bool operator==(const Conjunction& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
 		std::string symbol() const override;
 };
@@ -69,13 +63,14 @@ class Conjunction : public BinaryConnective {
 class Disjunction : public BinaryConnective {
 	public:
 		Disjunction(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r)
-			:BinaryConnective(l, r)
+			:BinaryConnective(FormulaType::Disjunction, l, r)
 		{}
 		
 		FormulaType type() const override;
 		bool operator==(const Disjunction& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
 		std::string symbol() const override;
 };
@@ -83,13 +78,14 @@ class Disjunction : public BinaryConnective {
 class Implication : public BinaryConnective {
 	public:
 		Implication(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r)
-			:BinaryConnective(l, r)
+			:BinaryConnective(FormulaType::Implication, l, r)
 		{}
 		
 		FormulaType type() const override;
 		bool operator==(const Implication& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
 		std::string symbol() const override;
 };
@@ -97,13 +93,14 @@ class Implication : public BinaryConnective {
 class Equivalence : public BinaryConnective {
 	public:
 		Equivalence(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r)
-			:BinaryConnective(l, r)
+			:BinaryConnective(FormulaType::Equivalence, l, r)
 		{}
 		
 		FormulaType type() const override;
 		bool operator==(const Equivalence& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
 		std::string symbol() const override;
 };
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "formula.hpp"
+
+// Hand-written recursive-descent parser for the grammar in parser.ypp, meant
+// for bulk input. It reads the buffer in place and builds nodes directly
+// through NodeFactory. Malformed input throws std::runtime_error.
+std::shared_ptr<Formula> fast_parse_formula(std::string_view input);
+// Maps the file into memory instead of reading it into a string first.
+std::shared_ptr<Formula> fast_parse_formula_file(const std::string& filename);
+
@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <sstream>
+#include <functional>
 
 #include "term.hpp"
 
@@ -21,19 +22,44 @@ enum class FormulaType {
 	Exists
 };
 
-class Formula {
+class Formula : public std::enable_shared_from_this<Formula> {
 	public:
-		virtual std::string to_string() const = 0;
+		std::string to_string() const;
+		virtual std::string format(const BinderNames& binders) const = 0;
 		virtual bool requires_parentheses() const = 0;
 		virtual FormulaType type() const = 0;
-		virtual std::set<std::string> get_variable_names() const = 0;
-		virtual std::set<std::string> get_free_variable_names() const = 0;
-		virtual std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const = 0;
-		virtual std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const = 0;
+		virtual std::shared_ptr<Formula> substitute(const Substitution& substitution) const = 0;
+		std::shared_ptr<Formula> replace(const Symbol& var_name, const std::shared_ptr<Term>& term) const;
+		std::shared_ptr<Formula> rename_var(const Symbol& old_name, const Symbol& new_name) const;
+		virtual std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const = 0;
+		// Term::instantiate_bound() on every term, with index counted from
+		// the binders enclosing the formula.
+		virtual std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const = 0;
+		const VariableSet& get_variable_names() const;
+		const VariableSet& get_free_variable_names() const;
+		unsigned size() const;
+		unsigned depth() const;
+		size_t hash() const;
+		// Like hash(), but 128 bits wide for the transposition table.
+		const SequentHash& sequent_hash() const;
+		unsigned loose_depth() const;
 		
-		static std::string generate_new_variable_name(const std::string& old_name, const std::set<std::string>& used_names);
+		static Symbol generate_new_variable_name(const Symbol& old_name, const VariableSet& used_names);
+		static Symbol generate_new_variable_name(const Symbol& old_name, const std::function<bool(const Symbol&)>& is_used);
+	protected:
+		std::shared_ptr<Formula> self() const;
+	protected:
+		VariableSet _variable_names;
+		VariableSet _free_variable_names;
+		unsigned _size = 1;
+		unsigned _depth = 1;
+		size_t _hash = 0;
+		SequentHash _sequent_hash;
+		unsigned _loose_depth = 0;
 };
 
+// Equality up to renaming of bound variables. Formula::hash() is invariant under
+// the same renaming, so equal formulas always have equal hashes.
 bool are_equal(const std::shared_ptr<Formula>& f1, const std::shared_ptr<Formula>& f2);
 
 std::ostream& operator<<(std::ostream& out, const Formula& formula);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+#include "formula.hpp"
+
+// Size, modification time and content hash of the file a cached formula was
+// built from, and which formula of that file it is.
+struct CacheKey {
+	uint64_t source_size = 0;
+	int64_t source_mtime = 0;
+	uint64_t source_hash = 0;
+	std::string selection;
+};
+
+// Binary image of a formula: a symbol table and a flat array of its distinct
+// nodes, children before parents, each referring to its children by index.
+// Loading it interns every node once, skipping the text entirely.
+void write_formula_cache(const std::string& filename, const std::shared_ptr<Formula>& formula, const CacheKey& key);
+
+// Returns nullptr if the file is missing, was written for another key, or is
+// not a valid image. The modification time is not compared.
+std::shared_ptr<Formula> read_formula_cache(const std::string& filename, const CacheKey& key);
+
+// Returns the formula cached in `source`.cache if it was built from the current
+// contents of the source with the same selection. Otherwise calls `load` and
+// stores its result there for the next time. Failing to write the cache is not
+// an error.
+std::shared_ptr<Formula> load_cached_formula(const std::string& source, const std::string& selection, const std::function<std::shared_ptr<Formula>()>& load);
+
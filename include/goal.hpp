@@ -1,80 +1,108 @@
 #pragma once
 
 #include <deque>
+#include <optional>
+#include <vector>
 
 #include "formula.hpp"
+#include "persistent.hpp"
+#include "rule.hpp"
+#include "sequent_hash.hpp"
 
 enum class RuleStatus {
 	Success,
 	Failure
 };
 
-struct ConjIResult {
-	RuleStatus status;
-	std::shared_ptr<Formula> new_target_1;
-	std::shared_ptr<Formula> new_target_2;
-};
-
-struct DisjEResult {
-	RuleStatus status;
-	std::shared_ptr<Formula> new_assumption_1;
-	std::shared_ptr<Formula> new_assumption_2;
-};
-
-struct IffIResult {
-	RuleStatus status;
-	std::shared_ptr<Formula> left_subformula;
-	std::shared_ptr<Formula> right_subformula;
-};
-
-struct ImpEResult {
-	RuleStatus status;
-	std::shared_ptr<Formula> left_subformula;
-	std::shared_ptr<Formula> right_subformula;
-};
+struct Successors;
 
 class Goal {
 	public:
 		Goal(const std::shared_ptr<Formula>& f)
-			:_meta_variables({}), _assumptions({}), _target_formula(f), _solved(false)
+			:_target_formula(f)
 		{}
 		
 		Goal(const std::deque<std::shared_ptr<Formula>>& a, const std::shared_ptr<Formula>& f)
-			:_meta_variables({}), _assumptions(a), _target_formula(f), _solved(false)
-		{}
+			:_target_formula(f)
+		{
+			for (const auto& assumption : a) {
+				add_assumption(assumption);
+			}
+		}
 		
 		std::string to_string() const;
 		void set_target(const std::shared_ptr<Formula>& formula);
+		std::shared_ptr<Formula> get_target() const;
+		// In the order of their keys, which is the order the elimination
+		// rules pick them in.
+		std::vector<std::shared_ptr<Formula>> get_assumptions() const;
+		// Position of the assumption equal to the formula up to the names of
+		// bound variables, in the order of get_assumptions.
+		std::optional<unsigned> get_assumption_position(const std::shared_ptr<Formula>& formula) const;
 		void add_assumption(const std::shared_ptr<Formula>& formula);
-		void remove_assumption(unsigned index);
-		std::set<std::string> get_free_vars_in_assumptions() const;
-		std::set<std::string> get_free_vars_in_target_formula() const;
-		std::set<std::string> get_free_variables() const;
-		RuleStatus apply_assumption();
-		RuleStatus apply_rule_not_i();
-		RuleStatus apply_erule_not_e();
-		ConjIResult apply_rule_conj_i();
-		RuleStatus apply_erule_conj_e();
-		RuleStatus apply_rule_disj_i_1();
-		RuleStatus apply_rule_disj_i_2();
-		DisjEResult apply_erule_disj_e();
-		RuleStatus apply_rule_imp_i();
-		ImpEResult apply_erule_imp_e();
-		IffIResult apply_rule_iff_i();
-		RuleStatus apply_erule_iff_e();
-		RuleStatus apply_rule_all_i();
-		RuleStatus apply_erule_all_e(const std::shared_ptr<Term>& replacement_term);
-		RuleStatus apply_rule_ex_i(const std::shared_ptr<Term>& replacement_term);
-		RuleStatus apply_erule_ex_e();
-		RuleStatus apply_rule_ccontr();
-		RuleStatus apply_rule_classical();
+		// Assumptions are identified by a key that grows with insertion order
+		// and stays valid until the assumption is removed.
+		void remove_assumption(unsigned key);
+		VariableSet get_free_vars_in_assumptions() const;
+		VariableSet get_free_vars_in_target_formula() const;
+		VariableSet get_free_variables() const;
+		// Equal for goals that differ only in the order of their assumptions
+		// and the names of their meta-variables. The assumptions that mention
+		// no meta-variable are hashed once, when they are added.
+		SequentHash canonical_hash() const;
+		// Leaves this goal unchanged; the successors share whatever the rule
+		// does not touch with it.
+		Successors apply(const RuleApplication& application) const;
 		void shift_assumptions(unsigned n);
 	private:
 		std::string body_to_string() const;
+		void track_assumption(unsigned key, const std::shared_ptr<Formula>& assumption);
+		void untrack_assumption(unsigned key, const std::shared_ptr<Formula>& assumption);
+		bool has_assumption(const std::shared_ptr<Formula>& formula) const;
+		bool is_used_variable(const Symbol& name) const;
+		bool mentions_meta_variable(const Formula& formula) const;
+		// The key of the assumption at the given position if it has the given
+		// type, or of the first assumption of that type without a position.
+		std::optional<unsigned> find_assumption(FormulaType type, std::optional<unsigned> position = std::nullopt) const;
+		Successors apply_assumption() const;
+		Successors apply_rule_not_i() const;
+		Successors apply_erule_not_e(std::optional<unsigned> position) const;
+		Successors apply_rule_conj_i() const;
+		Successors apply_erule_conj_e(std::optional<unsigned> position) const;
+		Successors apply_rule_disj_i_1() const;
+		Successors apply_rule_disj_i_2() const;
+		Successors apply_erule_disj_e(std::optional<unsigned> position) const;
+		Successors apply_rule_imp_i() const;
+		Successors apply_erule_imp_e(std::optional<unsigned> position) const;
+		Successors apply_rule_iff_i() const;
+		Successors apply_erule_iff_e(std::optional<unsigned> position) const;
+		Successors apply_rule_all_i() const;
+		Successors apply_erule_all_e(std::optional<unsigned> position, const std::vector<std::shared_ptr<Term>>& replacement_terms) const;
+		Successors apply_rule_ex_i(const std::vector<std::shared_ptr<Term>>& replacement_terms) const;
+		Successors apply_erule_ex_e(std::optional<unsigned> position) const;
+		Successors apply_rule_ccontr() const;
+		Successors apply_rule_classical() const;
 	private:
-		std::set<std::string> _meta_variables;
-		std::deque<std::shared_ptr<Formula>> _assumptions;
+		// All containers are persistent, so copying a goal when it splits is
+		// O(1) and the branches share their common context.
+		PersistentSet<Symbol> _meta_variables;
+		PersistentMap<unsigned, std::shared_ptr<Formula>> _assumptions;
+		PersistentSet<std::pair<FormulaType, unsigned>> _assumption_index;
+		// Keyed on (alpha-invariant hash, assumption key).
+		PersistentSet<std::pair<size_t, unsigned>> _assumption_hashes;
+		unsigned _next_assumption_key = 0;
 		std::shared_ptr<Formula> _target_formula;
-		bool _solved;
+		PersistentMap<Symbol, unsigned> _assumption_free_variable_counts;
+		// Sum of the hashes of the assumptions without meta-variables, and the
+		// keys of the others.
+		SequentHash _ground_assumption_hash;
+		PersistentSet<unsigned> _meta_assumption_keys;
+};
+
+// What a rule application leaves in place of the goal it was applied to: the
+// goals to prove instead, in order, and none when the rule closes the goal.
+struct Successors {
+	RuleStatus status;
+	std::vector<Goal> goals;
 };
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+inline size_t hash_combine(size_t seed, size_t value) {
+	return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+// 128-bit hash of a formula or a whole sequent, made of two independently
+// mixed 64-bit lanes. Adding hashes is commutative, which is what makes the
+// hash of an assumption set independent of its order and cheap to update.
+struct SequentHash {
+	uint64_t low = 0;
+	uint64_t high = 0;
+	
+	bool operator==(const SequentHash& other) const {
+		return low == other.low and high == other.high;
+	}
+	
+	bool operator!=(const SequentHash& other) const {
+		return !(*this == other);
+	}
+	
+	SequentHash& operator+=(const SequentHash& other) {
+		low += other.low;
+		high += other.high;
+		return *this;
+	}
+	
+	SequentHash& operator-=(const SequentHash& other) {
+		low -= other.low;
+		high -= other.high;
+		return *this;
+	}
+};
+
+inline uint64_t hash_mix(uint64_t x) {
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+// A node's SequentHash absorbs its kind, then its symbol, index or number of
+// children, then the hashes of its children in order.
+inline SequentHash sequent_hash_combine(const SequentHash& seed, uint64_t value) {
+	return {hash_mix(seed.low ^ (value + 0x9e3779b97f4a7c15ULL)), hash_mix(seed.high + (value ^ 0xc2b2ae3d27d4eb4fULL)) * 0x9fb21c651e98df25ULL};
+}
+
+inline SequentHash sequent_hash_combine(const SequentHash& seed, const SequentHash& child) {
+	return {hash_mix(seed.low ^ (child.low + 0x9e3779b97f4a7c15ULL)), hash_mix(seed.high + (child.high ^ 0xc2b2ae3d27d4eb4fULL)) * 0x9fb21c651e98df25ULL};
+}
+
+inline SequentHash sequent_hash_seed(uint64_t kind) {
+	return sequent_hash_combine(SequentHash{0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL}, kind);
+}
+
+namespace std {
+
+template <>
+struct hash<SequentHash> {
+	size_t operator()(const SequentHash& hash) const {
+		return hash.low;
+	}
+};
+
+}
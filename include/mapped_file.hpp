@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Read-only private mapping of a whole file.
+class MappedFile {
+	public:
+		MappedFile(const std::string& filename);
+		~MappedFile();
+		
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		
+		std::string_view contents() const;
+	private:
+		void* _data = nullptr;
+		size_t _size = 0;
+};
+
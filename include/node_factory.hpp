@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "term.hpp"
+#include "formula.hpp"
+
+class True;
+class False;
+class SimpleAtom;
+class ComplexAtom;
+class Negation;
+class Conjunction;
+class Disjunction;
+class Implication;
+class Equivalence;
+class ForAll;
+class Exists;
+
+// Every term and formula node is created through this factory. Structurally
+// identical nodes are shared, so two nodes are syntactically equal iff they are
+// the same object. Quantifiers keep the name of their variable for display, so
+// alpha-equivalent formulas may still be different objects and are compared
+// with are_equal().
+class NodeFactory {
+	public:
+		static std::shared_ptr<Variable> make_variable(const Symbol& name);
+		static std::shared_ptr<BoundVariable> make_bound_variable(unsigned index);
+		static std::shared_ptr<Constant> make_constant(const Symbol& name);
+		static std::shared_ptr<ComplexTerm> make_complex_term(const Symbol& f, const std::vector<std::shared_ptr<Term>>& terms);
+		
+		static std::shared_ptr<True> make_true();
+		static std::shared_ptr<False> make_false();
+		static std::shared_ptr<SimpleAtom> make_simple_atom(const Symbol& p);
+		static std::shared_ptr<ComplexAtom> make_complex_atom(const Symbol& p, const std::vector<std::shared_ptr<Term>>& terms);
+		static std::shared_ptr<Negation> make_negation(const std::shared_ptr<Formula>& sub);
+		static std::shared_ptr<Conjunction> make_conjunction(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r);
+		static std::shared_ptr<Disjunction> make_disjunction(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r);
+		static std::shared_ptr<Implication> make_implication(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r);
+		static std::shared_ptr<Equivalence> make_equivalence(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r);
+		static std::shared_ptr<ForAll> make_for_all(const Symbol& var, const std::shared_ptr<Formula>& sub);
+		static std::shared_ptr<Exists> make_exists(const Symbol& var, const std::shared_ptr<Formula>& sub);
+		
+		// Variants taking a subformula in which the quantified variable has
+		// already been abstracted to bound index 0.
+		static std::shared_ptr<ForAll> make_for_all_scope(const Symbol& var, const std::shared_ptr<Formula>& scope);
+		static std::shared_ptr<Exists> make_exists_scope(const Symbol& var, const std::shared_ptr<Formula>& scope);
+};
+
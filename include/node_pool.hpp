@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+// Fixed-size block pool. One pool exists per block size, so all nodes of the
+// same type (together with their shared_ptr control block) are carved out of
+// large chunks and recycled through a free list instead of going to malloc.
+// Each thread allocates from and frees to a cache of its own and only takes
+// the lock to move a batch of blocks between its cache and the shared list.
+template <size_t Size, size_t Align>
+class BlockPool {
+	public:
+		static BlockPool& instance() {
+			// Never destroyed: weak references to pooled nodes may outlive
+			// every other static object during program shutdown.
+			static BlockPool* pool = new BlockPool();
+			return *pool;
+		}
+		
+		void* allocate() {
+			ThreadCache* cache = thread_cache();
+			
+			if (cache == nullptr) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				
+				if (_free_list == nullptr) {
+					grow();
+				}
+				
+				Block* block = _free_list;
+				_free_list = block->next;
+				
+				return block;
+			}
+			
+			if (cache->free_list == nullptr) {
+				refill(*cache);
+			}
+			
+			Block* block = cache->free_list;
+			cache->free_list = block->next;
+			cache->count--;
+			
+			return block;
+		}
+		
+		void deallocate(void* p) {
+			Block* block = static_cast<Block*>(p);
+			ThreadCache* cache = thread_cache();
+			
+			if (cache == nullptr) {
+				std::lock_guard<std::mutex> lock(_mutex);
+				block->next = _free_list;
+				_free_list = block;
+				return;
+			}
+			
+			block->next = cache->free_list;
+			cache->free_list = block;
+			cache->count++;
+			
+			if (cache->count >= 2 * batch_size) {
+				release(*cache, batch_size);
+			}
+		}
+	private:
+		union Block {
+			Block* next;
+			alignas(Align) unsigned char storage[Size];
+		};
+		
+		// Hands its blocks back when the thread exits.
+		struct ThreadCache {
+			Block* free_list = nullptr;
+			size_t count = 0;
+			
+			~ThreadCache() {
+				instance().release(*this, count);
+				cache_destroyed() = true;
+			}
+		};
+		
+		// Set for the rest of the thread once its cache is gone. Nodes can
+		// still be freed then, by static objects destroyed at exit.
+		static bool& cache_destroyed() {
+			static thread_local bool destroyed = false;
+			return destroyed;
+		}
+		
+		static ThreadCache* thread_cache() {
+			if (cache_destroyed()) {
+				return nullptr;
+			}
+			
+			static thread_local ThreadCache cache;
+			return &cache;
+		}
+		
+		void refill(ThreadCache& cache) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			
+			if (_free_list == nullptr) {
+				grow();
+			}
+			
+			for (; _free_list != nullptr and cache.count < batch_size; cache.count++) {
+				Block* block = _free_list;
+				_free_list = block->next;
+				block->next = cache.free_list;
+				cache.free_list = block;
+			}
+		}
+		
+		// Moves the first `count` blocks of the cache to the shared list.
+		void release(ThreadCache& cache, size_t count) {
+			if (count == 0) {
+				return;
+			}
+			
+			Block* first = cache.free_list;
+			Block* last = first;
+			
+			for (size_t i = 1; i < count; i++) {
+				last = last->next;
+			}
+			
+			cache.free_list = last->next;
+			cache.count -= count;
+			
+			std::lock_guard<std::mutex> lock(_mutex);
+			
+			last->next = _free_list;
+			_free_list = first;
+		}
+		
+		void grow() {
+			_chunks.emplace_back(new Block[_chunk_size]);
+			
+			Block* chunk = _chunks.back().get();
+			for (size_t i = _chunk_size; i > 0; i--) {
+				chunk[i - 1].next = _free_list;
+				_free_list = &chunk[i - 1];
+			}
+			
+			if (_chunk_size < max_chunk_size) {
+				_chunk_size *= 2;
+			}
+		}
+	private:
+		static constexpr size_t max_chunk_size = 1 << 16;
+		static constexpr size_t batch_size = 256;
+		
+		std::mutex _mutex;
+		std::vector<std::unique_ptr<Block[]>> _chunks;
+		Block* _free_list = nullptr;
+		size_t _chunk_size = 64;
+};
+
+template <typename T>
+class PoolAllocator {
+	public:
+		using value_type = T;
+		
+		PoolAllocator() noexcept = default;
+		
+		template <typename U>
+		PoolAllocator(const PoolAllocator<U>&) noexcept
+		{}
+		
+		T* allocate(size_t n) {
+			if (n != 1) {
+				return static_cast<T*>(::operator new(n * sizeof(T)));
+			}
+			
+			return static_cast<T*>(BlockPool<sizeof(T), alignof(T)>::instance().allocate());
+		}
+		
+		void deallocate(T* p, size_t n) noexcept {
+			if (n != 1) {
+				::operator delete(p);
+				return;
+			}
+			
+			BlockPool<sizeof(T), alignof(T)>::instance().deallocate(p);
+		}
+		
+		template <typename U>
+		bool operator==(const PoolAllocator<U>&) const noexcept {
+			return true;
+		}
+		
+		template <typename U>
+		bool operator!=(const PoolAllocator<U>&) const noexcept {
+			return false;
+		}
+};
+
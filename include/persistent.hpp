@@ -0,0 +1,371 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+
+#include "node_pool.hpp"
+
+// Immutable balanced search tree (AVL). Every update copies only the path from
+// the root to the changed node and shares the rest, so copying a container is
+// O(1) and old versions stay valid after the copy is modified.
+template <typename Entry, typename Key, typename KeyOf, typename Compare>
+class PersistentTree {
+	private:
+		struct Node;
+		using NodePtr = std::shared_ptr<const Node>;
+		
+		struct Node {
+			Entry entry;
+			NodePtr left;
+			NodePtr right;
+			unsigned height;
+			size_t size;
+		};
+	public:
+		class const_iterator {
+			public:
+				const Entry& operator*() const {
+					return _path.back()->entry;
+				}
+				
+				const Entry* operator->() const {
+					return &_path.back()->entry;
+				}
+				
+				const_iterator& operator++() {
+					const Node* node = _path.back();
+					_path.pop_back();
+					push_left_spine(node->right.get());
+					return *this;
+				}
+				
+				bool operator==(const const_iterator& other) const {
+					return current() == other.current();
+				}
+				
+				bool operator!=(const const_iterator& other) const {
+					return current() != other.current();
+				}
+			private:
+				friend class PersistentTree;
+				
+				const Node* current() const {
+					return _path.empty() ? nullptr : _path.back();
+				}
+				
+				void push_left_spine(const Node* node) {
+					for (; node != nullptr; node = node->left.get()) {
+						_path.push_back(node);
+					}
+				}
+			private:
+				// Ancestors still to be visited, the current node last.
+				std::vector<const Node*> _path;
+		};
+		
+		size_t size() const {
+			return size_of(_root);
+		}
+		
+		bool empty() const {
+			return _root == nullptr;
+		}
+		
+		bool contains(const Key& key) const {
+			return find(key) != nullptr;
+		}
+		
+		const_iterator begin() const {
+			const_iterator it;
+			it.push_left_spine(_root.get());
+			return it;
+		}
+		
+		const_iterator end() const {
+			return const_iterator();
+		}
+		
+		// First entry whose key is not less than the given one.
+		const_iterator lower_bound(const Key& key) const {
+			const_iterator it;
+			
+			for (const Node* node = _root.get(); node != nullptr;) {
+				if (_compare(key_of(node), key)) {
+					node = node->right.get();
+				} else {
+					it._path.push_back(node);
+					node = node->left.get();
+				}
+			}
+			
+			return it;
+		}
+		
+		// The entry with the given key, or nullptr. Unlike lower_bound(), this
+		// does not build an iterator path.
+		const Entry* find(const Key& key) const {
+			for (const Node* node = _root.get(); node != nullptr;) {
+				if (_compare(key, key_of(node))) {
+					node = node->left.get();
+				} else if (_compare(key_of(node), key)) {
+					node = node->right.get();
+				} else {
+					return &node->entry;
+				}
+			}
+			
+			return nullptr;
+		}
+		
+		// The entry at the given position in key order, which must be less
+		// than size(). Logarithmic, through the subtree sizes.
+		const Entry& nth(size_t position) const {
+			const Node* node = _root.get();
+			
+			for (;;) {
+				size_t left_size = size_of(node->left);
+				
+				if (position < left_size) {
+					node = node->left.get();
+				} else if (position == left_size) {
+					return node->entry;
+				} else {
+					position -= left_size + 1;
+					node = node->right.get();
+				}
+			}
+		}
+		
+		void erase(const Key& key) {
+			_root = erase(_root, key);
+		}
+	protected:
+		void insert_entry(const Entry& entry) {
+			_root = insert(_root, entry);
+		}
+	private:
+		static const Key& key_of(const Node* node) {
+			return KeyOf()(node->entry);
+		}
+		
+		static unsigned height_of(const NodePtr& node) {
+			return node ? node->height : 0;
+		}
+		
+		static size_t size_of(const NodePtr& node) {
+			return node ? node->size : 0;
+		}
+		
+		static NodePtr make_node(const Entry& entry, const NodePtr& left, const NodePtr& right) {
+			unsigned height = std::max(height_of(left), height_of(right)) + 1;
+			size_t size = size_of(left) + size_of(right) + 1;
+			
+			return std::allocate_shared<const Node>(PoolAllocator<Node>(), Node{entry, left, right, height, size});
+		}
+		
+		static NodePtr balance(const Entry& entry, const NodePtr& left, const NodePtr& right) {
+			unsigned left_height = height_of(left);
+			unsigned right_height = height_of(right);
+			
+			if (left_height > right_height + 1) {
+				if (height_of(left->left) >= height_of(left->right)) {
+					return make_node(left->entry, left->left, make_node(entry, left->right, right));
+				}
+				
+				const NodePtr& middle = left->right;
+				return make_node(middle->entry, make_node(left->entry, left->left, middle->left), make_node(entry, middle->right, right));
+			}
+			
+			if (right_height > left_height + 1) {
+				if (height_of(right->right) >= height_of(right->left)) {
+					return make_node(right->entry, make_node(entry, left, right->left), right->right);
+				}
+				
+				const NodePtr& middle = right->left;
+				return make_node(middle->entry, make_node(entry, left, middle->left), make_node(right->entry, middle->right, right->right));
+			}
+			
+			return make_node(entry, left, right);
+		}
+		
+		NodePtr insert(const NodePtr& node, const Entry& entry) const {
+			if (!node) {
+				return make_node(entry, nullptr, nullptr);
+			}
+			
+			const Key& key = KeyOf()(entry);
+			
+			if (_compare(key, key_of(node.get()))) {
+				return balance(node->entry, insert(node->left, entry), node->right);
+			}
+			
+			if (_compare(key_of(node.get()), key)) {
+				return balance(node->entry, node->left, insert(node->right, entry));
+			}
+			
+			return make_node(entry, node->left, node->right);
+		}
+		
+		NodePtr erase(const NodePtr& node, const Key& key) const {
+			if (!node) {
+				return nullptr;
+			}
+			
+			if (_compare(key, key_of(node.get()))) {
+				NodePtr left = erase(node->left, key);
+				return left == node->left ? node : balance(node->entry, left, node->right);
+			}
+			
+			if (_compare(key_of(node.get()), key)) {
+				NodePtr right = erase(node->right, key);
+				return right == node->right ? node : balance(node->entry, node->left, right);
+			}
+			
+			if (!node->left) {
+				return node->right;
+			}
+			
+			if (!node->right) {
+				return node->left;
+			}
+			
+			const Node* successor = node->right.get();
+			while (successor->left) {
+				successor = successor->left.get();
+			}
+			
+			return balance(successor->entry, node->left, erase_min(node->right));
+		}
+		
+		static NodePtr erase_min(const NodePtr& node) {
+			if (!node->left) {
+				return node->right;
+			}
+			
+			return balance(node->entry, erase_min(node->left), node->right);
+		}
+	private:
+		NodePtr _root;
+		Compare _compare;
+};
+
+template <typename Key, typename Value>
+struct PersistentMapKeyOf {
+	const Key& operator()(const std::pair<const Key, Value>& entry) const {
+		return entry.first;
+	}
+};
+
+template <typename Key>
+struct PersistentSetKeyOf {
+	const Key& operator()(const Key& entry) const {
+		return entry;
+	}
+};
+
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class PersistentMap : public PersistentTree<std::pair<const Key, Value>, Key, PersistentMapKeyOf<Key, Value>, Compare> {
+	public:
+		// Inserts the entry, replacing the value of an existing key.
+		void insert(const Key& key, const Value& value) {
+			this->insert_entry({key, value});
+		}
+		
+		const Value& at(const Key& key) const {
+			auto entry = this->find(key);
+			
+			if (entry == nullptr) {
+				throw std::out_of_range("PersistentMap::at");
+			}
+			
+			return entry->second;
+		}
+};
+
+template <typename Key, typename Compare = std::less<Key>>
+class PersistentSet : public PersistentTree<Key, Key, PersistentSetKeyOf<Key>, Compare> {
+	public:
+		void insert(const Key& key) {
+			this->insert_entry(key);
+		}
+};
+
+// Immutable singly linked list. Pushing and popping at the front are O(1), and
+// copies share their common tail.
+template <typename T>
+class PersistentList {
+	private:
+		struct Node;
+		using NodePtr = std::shared_ptr<const Node>;
+		
+		struct Node {
+			T value;
+			NodePtr next;
+			size_t size;
+		};
+	public:
+		class const_iterator {
+			public:
+				const T& operator*() const {
+					return _node->value;
+				}
+				
+				const T* operator->() const {
+					return &_node->value;
+				}
+				
+				const_iterator& operator++() {
+					_node = _node->next.get();
+					return *this;
+				}
+				
+				bool operator==(const const_iterator& other) const {
+					return _node == other._node;
+				}
+				
+				bool operator!=(const const_iterator& other) const {
+					return _node != other._node;
+				}
+			private:
+				friend class PersistentList;
+				
+				const Node* _node = nullptr;
+		};
+		
+		size_t size() const {
+			return _head ? _head->size : 0;
+		}
+		
+		bool empty() const {
+			return _head == nullptr;
+		}
+		
+		const T& front() const {
+			return _head->value;
+		}
+		
+		void push_front(const T& value) {
+			_head = std::allocate_shared<const Node>(PoolAllocator<Node>(), Node{value, _head, size() + 1});
+		}
+		
+		void pop_front() {
+			_head = _head->next;
+		}
+		
+		const_iterator begin() const {
+			const_iterator it;
+			it._node = _head.get();
+			return it;
+		}
+		
+		const_iterator end() const {
+			return const_iterator();
+		}
+	private:
+		NodePtr _head;
+};
+
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+#include "formula.hpp"
+
+// One `fof(name, role, formula).` entry of a problem file. The formula is kept
+// as text and parsed only on request, so entries can be scanned and selected
+// without building the formulas of those that are not needed.
+struct ProblemEntry {
+	std::string name;
+	std::string role;
+	std::string formula_text;
+	// Where the entry starts, for coming back to it with ProblemReader::seek.
+	std::streampos position;
+	unsigned line;
+	
+	std::shared_ptr<Formula> parse_formula() const;
+	bool is_premise() const;
+};
+
+// Axioms, hypotheses, definitions, assumptions, lemmas, theorems and
+// corollaries may be used to prove a conjecture.
+bool is_premise_role(const std::string& role);
+
+// Reads the entries of a problem file one at a time, so only the entry being
+// read is held in memory. Text from % to the end of the line is a comment.
+class ProblemReader {
+	public:
+		ProblemReader(std::istream& input)
+			:_input(input)
+		{}
+		
+		// Returns false at the end of the input. Malformed entries throw
+		// std::runtime_error.
+		bool next(ProblemEntry& entry);
+		void seek(const ProblemEntry& entry);
+	private:
+		int get();
+		void skip_line();
+		void skip_whitespace();
+		std::string read_word();
+		void expect(char c);
+		std::runtime_error error(const std::string& message) const;
+	private:
+		std::istream& _input;
+		unsigned _line = 1;
+};
+
+// The formula `p1 => (p2 => ... => conjecture)`, so that each premise becomes a
+// separate assumption after repeated impI.
+std::shared_ptr<Formula> make_problem_goal(const std::vector<std::shared_ptr<Formula>>& premises, const std::shared_ptr<Formula>& conjecture);
+
+// Streams a problem file and builds the goal for the named entry, using every
+// premise in the file.
+std::shared_ptr<Formula> read_problem_goal(const std::string& filename, const std::string& conjecture_name);
+
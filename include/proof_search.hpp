@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "proof_state_manager.hpp"
+
+struct SearchOptions {
+	// Most non-invertible steps on any branch of the proof.
+	unsigned max_depth = 8;
+	// Rule applications tried before giving up.
+	unsigned long max_steps = 1000000;
+	// Threads searching independent goals and alternatives side by side,
+	// including the calling one. Which proof is found then depends on timing.
+	unsigned threads = 1;
+	// Goals whose proof or failure is remembered, so that a goal met again
+	// with its assumptions in another order or its meta-variables named
+	// differently is not searched again. 0 turns this off.
+	size_t table_entries = 1 << 16;
+};
+
+struct ProofStep {
+	RuleApplication application;
+	// The same step as a prover command.
+	std::string command;
+};
+
+struct SearchResult {
+	bool proved;
+	// Steps that solve every goal when applied in order to the searched state.
+	std::vector<ProofStep> proof;
+	unsigned long steps;
+};
+
+// Iterative deepening search over the natural deduction rules. Invertible rules
+// are applied as soon as they match and never undone. disjI1, disjI2, impE,
+// allE, exI, notE, ccontr and classical are backtracked over, instantiating
+// quantifiers with the closed terms of the goal. The goals share no unknowns,
+// so each is proved on its own and its proof is never revisited.
+SearchResult search_proof(const ProofStateManager& state, const SearchOptions& options = SearchOptions());
+
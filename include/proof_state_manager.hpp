@@ -2,10 +2,13 @@
 
 #include <string>
 #include <memory>
-#include <deque>
+#include <optional>
+#include <vector>
 
 #include "formula.hpp"
 #include "goal.hpp"
+#include "persistent.hpp"
+#include "rule.hpp"
 
 enum class ManagerStatusCode {
 	Success,
@@ -25,35 +28,30 @@ struct ManagerStatus {
 class ProofStateManager {
 	public:
 		ProofStateManager(const std::shared_ptr<Formula>& formula_to_prove)
-			:_goals({Goal(formula_to_prove)})
-		{}
+		{
+			_goals.push_front(Goal(formula_to_prove));
+		}
 		
 		ProofStateManager(const Goal& initial_goal)
-			:_goals({initial_goal})
-		{}
+		{
+			_goals.push_front(initial_goal);
+		}
 		
 		std::string to_string() const;
-		ManagerStatus apply_assumption();
-		ManagerStatus apply_rule_not_i();
-		ManagerStatus apply_erule_not_e();
-		ManagerStatus apply_rule_conj_i();
-		ManagerStatus apply_erule_conj_e();
-		ManagerStatus apply_rule_disj_i_1();
-		ManagerStatus apply_rule_disj_i_2();
-		ManagerStatus apply_erule_disj_e();
-		ManagerStatus apply_rule_imp_i();
-		ManagerStatus apply_erule_imp_e();
-		ManagerStatus apply_rule_iff_i();
-		ManagerStatus apply_erule_iff_e();
-		ManagerStatus apply_rule_all_i();
-		ManagerStatus apply_erule_all_e(const std::shared_ptr<Term>& replacement_term);
-		ManagerStatus apply_rule_ex_i(const std::shared_ptr<Term>& replacement_term);
-		ManagerStatus apply_erule_ex_e();
-		ManagerStatus apply_rule_ccontr();
-		ManagerStatus apply_rule_classical();
+		// The state after applying a rule to the current goal, or nothing when
+		// there is no goal or the rule does not apply to it. This state is left
+		// as it is and shares everything the rule does not touch.
+		std::optional<ProofStateManager> successor(const RuleApplication& application) const;
+		ManagerStatus apply(const RuleApplication& application);
 		bool goals_solved() const;
+		size_t goals_left() const;
+		// The goal the rules apply to. There must be one.
+		const Goal& current_goal() const;
+		// Every goal, the current one first.
+		std::vector<Goal> get_goals() const;
 		ManagerStatus shift();
 	private:
-		std::deque<Goal> _goals;
+		// Persistent, so copying the manager is O(1) and snapshots share goals.
+		PersistentList<Goal> _goals;
 };
 
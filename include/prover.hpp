@@ -1,14 +1,26 @@
 #pragma once
 
+#include <map>
+#include <istream>
+#include <sstream>
+#include <vector>
+#include <string>
+
 #include "formula.hpp"
 #include "goal.hpp"
 #include "proof_state_manager.hpp"
 #include "command.hpp"
+#include "proof_search.hpp"
 
 constexpr const char* commands =
 	"Commands:\n"
 	"* apply - apply a natural deduction rule on current goal (for the list of available rules, see 'list')\n"
 	"* shift - rotate the assumptions of current goal (one position to the left)\n"
+	"* undo - revert the last rule application or shift\n"
+	"* redo - reapply the last undone step\n"
+	"* checkpoint <name> - save the current proof state under a name\n"
+	"* restore <name> - return to a saved proof state\n"
+	"* auto [depth] - search for a proof of all remaining goals and apply it, printing the commands it consists of\n"
 	"* help - display this help message\n"
 	"* list - show list of natural deduction rules\n"
 	"* exit - stop the program";
@@ -33,6 +45,7 @@ constexpr const char* list_of_rules =
 	"apply erule iffE\n"
 	"apply erule allE\n"
 	"apply erule exE\n"
+	"(the first fitting assumption is eliminated; choose another one by its position, as in 'apply erule impE[2]', or by the assumption itself, as in 'apply erule impE[p(a) => q(a)]')\n"
 	"4) Rules of classical logic:\n"
 	"apply rule ccontr\n"
 	"apply rule classical";
@@ -43,18 +56,47 @@ enum class ExecuteStatus {
 	StopFailure
 };
 
+struct ScriptResult {
+	bool proved;
+	unsigned steps;
+	std::string error;
+};
+
 class Prover {
 	public:
-		static void start_interactive_proof(const std::shared_ptr<Formula>&);
+		// The auto command searches with the given number of threads.
+		static void start_interactive_proof(const std::shared_ptr<Formula>&, unsigned search_threads = 1);
+		// Replays a proof script without prompting or rendering. Stops at the
+		// first command that fails; with verbose set, the proof state is
+		// printed after every command.
+		// The auto command searches on a single thread here, since scripts
+		// are checked side by side by prover-check.
+		static ScriptResult check_proof_script(const std::shared_ptr<Formula>&, std::istream& script, bool verbose);
 	private:
-		Prover(const std::shared_ptr<Formula>&);
+		Prover(const std::shared_ptr<Formula>&, bool script_mode, unsigned search_threads);
 		void start();
 		void print_intro_message();
 		ExecuteStatus execute(const Command&);
-		ManagerStatus apply_rule(const Rule&);
+		ManagerStatus apply_rule(const Rule&, const std::string& argument, const std::string& assumption);
+		ExecuteStatus apply_auto(const std::string& argument);
+		std::shared_ptr<Term> get_term(const std::string& argument);
 		std::shared_ptr<Term> get_term_from_user();
+		std::optional<unsigned> get_assumption_position(const std::string& assumption);
+		void record_step(const ProofStateManager& previous_state);
 	private:
 		std::shared_ptr<Formula> _formula_to_prove;
 		ProofStateManager _proof_state_manager;
+		bool _script_mode;
+		// Threads the auto command searches with.
+		unsigned _search_threads;
+		// Messages about the executed commands: the terminal in interactive
+		// mode, a buffer that ends up in ScriptResult::error in script mode.
+		std::ostringstream _script_messages;
+		std::ostream& _messages;
+		// Snapshots share all unchanged goals and assumptions, so each one
+		// costs only the nodes touched by a single step.
+		std::vector<ProofStateManager> _undo_history;
+		std::vector<ProofStateManager> _redo_history;
+		std::map<std::string, ProofStateManager> _checkpoints;
 };
 
@@ -2,55 +2,56 @@
 
 #include "formula.hpp"
 
+// The subformula of a quantifier is stored in locally nameless form: occurrences
+// of the quantified variable are BoundVariable terms, and the variable name is
+// kept only for display.
 class Quantifier : public Formula {
 	public:
-		Quantifier(const std::string& var, const std::shared_ptr<Formula>& sub)
-			:_variable_name(var), _subformula(sub)
-		{}
+		Quantifier(FormulaType type, const Symbol& var, const std::shared_ptr<Formula>& sub);
 		
-		std::string to_string() const override;
-		std::string get_variable_name() const;
+		std::string format(const BinderNames& binders) const override;
+		Symbol get_variable_name() const;
 		std::shared_ptr<Formula> get_subformula() const;
-		std::set<std::string> get_variable_names() const override;
-		std::set<std::string> get_free_variable_names() const override;
-		virtual std::shared_ptr<Quantifier> alpha_convert() const = 0;
-		virtual std::shared_ptr<Quantifier> alpha_convert(const std::string& new_var_name) const = 0;
+		std::shared_ptr<Formula> instantiate(const std::shared_ptr<Term>& term) const;
+		// Strips terms.size() directly nested quantifiers of this kind and
+		// instantiates their variables, outermost first, in one pass. Returns
+		// nullptr if terms is empty or there are fewer such quantifiers.
+		std::shared_ptr<Formula> instantiate(const std::vector<std::shared_ptr<Term>>& terms) const;
 	protected:
 		virtual std::string symbol() const = 0;
 		bool requires_parentheses() const override;
+		Symbol display_name(const BinderNames& binders) const;
 	protected:
-		std::string _variable_name;
+		Symbol _variable_name;
 		std::shared_ptr<Formula> _subformula;
 };
 
 class ForAll : public Quantifier {
 	public:
-		ForAll(const std::string& var, const std::shared_ptr<Formula>& sub)
-			:Quantifier(var, sub)
+		ForAll(const Symbol& var, const std::shared_ptr<Formula>& sub)
+			:Quantifier(FormulaType::ForAll, var, sub)
 		{}
 		
 		FormulaType type() const override;
 		bool operator==(const ForAll& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
-		std::shared_ptr<Quantifier> alpha_convert() const override;
-		std::shared_ptr<Quantifier> alpha_convert(const std::string& new_var_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
 		std::string symbol() const override;
 };
 
 class Exists : public Quantifier {
 	public:
-		Exists(const std::string& var, const std::shared_ptr<Formula>& sub)
-			:Quantifier(var, sub)
+		Exists(const Symbol& var, const std::shared_ptr<Formula>& sub)
+			:Quantifier(FormulaType::Exists, var, sub)
 		{}
 		
 		FormulaType type() const override;
 		bool operator==(const Exists& other) const;
-		std::shared_ptr<Formula> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Formula> rename_var(const std::string& old_name, const std::string& new_name) const override;
-		std::shared_ptr<Quantifier> alpha_convert() const override;
-		std::shared_ptr<Quantifier> alpha_convert(const std::string& new_var_name) const override;
+		std::shared_ptr<Formula> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Formula> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Formula> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
 		std::string symbol() const override;
 };
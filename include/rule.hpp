@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "term.hpp"
+
+enum class Rule {
+	Assumption,
+	NotI,
+	NotE,
+	ConjI,
+	ConjE,
+	DisjI1,
+	DisjI2,
+	DisjE,
+	ImpI,
+	ImpE,
+	IffI,
+	IffE,
+	AllI,
+	AllE,
+	ExI,
+	ExE,
+	Ccontr,
+	Classical
+};
+
+struct RuleApplication {
+	Rule rule;
+	// Position of the assumption an elimination rule works on, counted from 0
+	// in the order the assumptions are listed. Without one, the rule takes the
+	// first assumption it applies to.
+	std::optional<unsigned> assumption = std::nullopt;
+	// Instantiation of allE and exI.
+	std::vector<std::shared_ptr<Term>> terms = {};
+};
+
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include "formula.hpp"
+
+// Gives the free variables it knows a number to hash by instead of their name.
+using VariableNumbering = std::function<std::optional<unsigned>(const Symbol&)>;
+
+// Formula::sequent_hash(), except that variables numbered by `numbering` hash
+// by that number instead of their name.
+SequentHash hash_formula(const Formula& formula, const VariableNumbering& numbering = nullptr);
+
+// The same hash with a role mixed in, so that for example a formula as the
+// target and the same formula as an assumption do not hash alike.
+SequentHash tag_hash(const SequentHash& hash, uint64_t tag);
+
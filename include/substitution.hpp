@@ -0,0 +1,27 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <initializer_list>
+
+#include "symbol.hpp"
+
+class Term;
+
+// Simultaneous substitution of terms for free variables, applied to a whole
+// formula in a single traversal. Quantified variables are stored as bound
+// indices, so the substituted terms can never be captured.
+class Substitution {
+	public:
+		Substitution() = default;
+		Substitution(std::initializer_list<std::pair<const Symbol, std::shared_ptr<Term>>> bindings);
+		
+		void bind(const Symbol& var_name, const std::shared_ptr<Term>& term);
+		std::shared_ptr<Term> find(const Symbol& var_name) const;
+		bool affects(const VariableSet& variables) const;
+		bool empty() const;
+	private:
+		std::map<Symbol, std::shared_ptr<Term>> _bindings;
+};
+
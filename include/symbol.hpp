@@ -0,0 +1,129 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+
+// Interned name. Every distinct identifier is stored once in a global table and
+// referred to by a dense integer id, so comparing and copying symbols is cheap.
+class Symbol {
+	public:
+		Symbol() = delete;
+		explicit Symbol(const std::string& name);
+
+		// The symbol an id() was taken from, for code that can only carry
+		// trivial values, such as the parser's semantic values.
+		static Symbol from_id(unsigned id) {
+			return Symbol(id);
+		}
+
+		const std::string& name() const;
+
+		unsigned id() const {
+			return _id;
+		}
+
+		bool operator==(const Symbol& other) const {
+			return _id == other._id;
+		}
+
+		bool operator!=(const Symbol& other) const {
+			return _id != other._id;
+		}
+
+		bool operator<(const Symbol& other) const {
+			return _id < other._id;
+		}
+	private:
+		explicit Symbol(unsigned id)
+			:_id(id)
+		{}
+	private:
+		unsigned _id;
+};
+
+namespace std {
+
+template <>
+struct hash<Symbol> {
+	size_t operator()(const Symbol& symbol) const {
+		return symbol.id();
+	}
+};
+
+}
+
+// Set of symbols kept as a vector sorted by symbol id.
+class VariableSet {
+	public:
+		using const_iterator = std::vector<Symbol>::const_iterator;
+
+		VariableSet() = default;
+
+		VariableSet(std::initializer_list<Symbol> symbols) {
+			for (const auto& s : symbols) {
+				insert(s);
+			}
+		}
+
+		// Takes symbols in any order and with repeats. Collecting the members
+		// of many sets and building once avoids merging them one at a time.
+		explicit VariableSet(std::vector<Symbol> symbols)
+			:_symbols(std::move(symbols))
+		{
+			std::sort(_symbols.begin(), _symbols.end());
+			_symbols.erase(std::unique(_symbols.begin(), _symbols.end()), _symbols.end());
+		}
+
+		bool contains(const Symbol& s) const {
+			return std::binary_search(_symbols.begin(), _symbols.end(), s);
+		}
+
+		void insert(const Symbol& s) {
+			auto it = std::lower_bound(_symbols.begin(), _symbols.end(), s);
+
+			if (it == _symbols.end() or *it != s) {
+				_symbols.insert(it, s);
+			}
+		}
+
+		void insert(const VariableSet& other) {
+			if (other._symbols.empty()) {
+				return;
+			}
+
+			std::vector<Symbol> merged;
+			merged.reserve(_symbols.size() + other._symbols.size());
+			std::set_union(_symbols.begin(), _symbols.end(), other._symbols.begin(), other._symbols.end(), std::back_inserter(merged));
+			_symbols.swap(merged);
+		}
+
+		void erase(const Symbol& s) {
+			auto it = std::lower_bound(_symbols.begin(), _symbols.end(), s);
+
+			if (it != _symbols.end() and *it == s) {
+				_symbols.erase(it);
+			}
+		}
+
+		bool empty() const {
+			return _symbols.empty();
+		}
+
+		size_t size() const {
+			return _symbols.size();
+		}
+
+		const_iterator begin() const {
+			return _symbols.begin();
+		}
+
+		const_iterator end() const {
+			return _symbols.end();
+		}
+	private:
+		std::vector<Symbol> _symbols;
+};
+
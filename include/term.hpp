@@ -3,21 +3,52 @@
 #include <string>
 #include <memory>
 #include <vector>
-#include <set>
+
+#include "symbol.hpp"
+#include "hash.hpp"
 
 enum class TermType {
 	Variable,
 	Constant,
-	ComplexTerm
+	ComplexTerm,
+	BoundVariable
 };
 
-class Term {
+class Substitution;
+
+// Display names of the binders enclosing a node, innermost last.
+using BinderNames = std::vector<Symbol>;
+
+// Substitutions return the node itself for any subtree they leave unchanged, so
+// only the path down to actual occurrences is rebuilt.
+class Term : public std::enable_shared_from_this<Term> {
 	public:
-		virtual std::string to_string() const = 0;
+		std::string to_string() const;
+		virtual std::string format(const BinderNames& binders) const = 0;
 		virtual TermType type() const = 0;
-		virtual std::set<std::string> get_variable_names() const = 0;
-		virtual std::shared_ptr<Term> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const = 0;
-		virtual std::shared_ptr<Term> rename_var(const std::string& old_name, const std::string& new_name) const = 0;
+		virtual std::shared_ptr<Term> substitute(const Substitution& substitution) const = 0;
+		std::shared_ptr<Term> replace(const Symbol& var_name, const std::shared_ptr<Term>& term) const;
+		std::shared_ptr<Term> rename_var(const Symbol& old_name, const Symbol& new_name) const;
+		virtual std::shared_ptr<Term> abstract_var(const Symbol& var_name, unsigned index) const = 0;
+		// Replaces bound variable index + i with terms[i], which must be closed,
+		// and renumbers the bound variables past them as if the binders of the
+		// terms had been removed.
+		virtual std::shared_ptr<Term> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const = 0;
+		const VariableSet& get_variable_names() const;
+		unsigned size() const;
+		unsigned depth() const;
+		size_t hash() const;
+		const SequentHash& sequent_hash() const;
+		unsigned loose_depth() const;
+	protected:
+		std::shared_ptr<Term> self() const;
+	protected:
+		VariableSet _variable_names;
+		unsigned _size = 1;
+		unsigned _depth = 1;
+		size_t _hash = 0;
+		SequentHash _sequent_hash;
+		unsigned _loose_depth = 0;
 };
 
 bool are_equal(const std::shared_ptr<Term>& t1, const std::shared_ptr<Term>& t2);
@@ -26,50 +57,65 @@ std::ostream& operator<<(std::ostream& out, const Term& term);
 
 class Variable : public Term {
 	public:
-		Variable(const std::string& name)
-			:_name(name)
-		{}
+		Variable(const Symbol& name);
 		
-		std::string to_string() const override;
+		std::string format(const BinderNames& binders) const override;
 		TermType type() const override;
 		bool operator==(const Variable& other) const;
-		std::set<std::string> get_variable_names() const override;
-		std::shared_ptr<Term> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Term> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		Symbol get_name() const;
+		std::shared_ptr<Term> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Term> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Term> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
+	private:
+		Symbol _name;
+};
+
+// Occurrence of a quantified variable, as a de Bruijn index: 0 refers to the
+// innermost enclosing binder, 1 to the one around it, and so on.
+class BoundVariable : public Term {
+	public:
+		BoundVariable(unsigned index);
+		
+		std::string format(const BinderNames& binders) const override;
+		TermType type() const override;
+		bool operator==(const BoundVariable& other) const;
+		unsigned get_index() const;
+		std::shared_ptr<Term> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Term> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Term> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
-		std::string _name;
+		unsigned _index;
 };
 
 class Constant : public Term {
 	public:
-		Constant(const std::string& name)
-			:_name(name)
-		{}
+		Constant(const Symbol& name);
 		
-		std::string to_string() const override;
+		std::string format(const BinderNames& binders) const override;
 		TermType type() const override;
 		bool operator==(const Constant& other) const;
-		std::set<std::string> get_variable_names() const override;
-		std::shared_ptr<Term> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Term> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		Symbol get_name() const;
+		std::shared_ptr<Term> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Term> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Term> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
-		std::string _name;
+		Symbol _name;
 };
 
 class ComplexTerm : public Term {
 	public:
-		ComplexTerm(const std::string& f, const std::vector<std::shared_ptr<Term>>& terms)
-			:_function_symbol(f), _subterms(terms)
-		{}
+		ComplexTerm(const Symbol& f, const std::vector<std::shared_ptr<Term>>& terms);
 		
-		std::string to_string() const override;
+		std::string format(const BinderNames& binders) const override;
 		TermType type() const override;
 		bool operator==(const ComplexTerm& other) const;
-		std::set<std::string> get_variable_names() const override;
-		std::shared_ptr<Term> replace(const std::string& var_name, const std::shared_ptr<Term>& term) const override;
-		std::shared_ptr<Term> rename_var(const std::string& old_name, const std::string& new_name) const override;
+		Symbol get_function_symbol() const;
+		const std::vector<std::shared_ptr<Term>>& get_subterms() const;
+		std::shared_ptr<Term> substitute(const Substitution& substitution) const override;
+		std::shared_ptr<Term> abstract_var(const Symbol& var_name, unsigned index) const override;
+		std::shared_ptr<Term> instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const override;
 	private:
-		std::string _function_symbol;
+		Symbol _function_symbol;
 		std::vector<std::shared_ptr<Term>> _subterms;
 };
 
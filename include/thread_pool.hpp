@@ -0,0 +1,55 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed set of worker threads with one task queue each. A worker takes tasks
+// from the back of its own queue and, when that is empty, steals from the
+// front of the others, so uneven tasks still keep every core busy.
+class WorkStealingPool {
+	public:
+		explicit WorkStealingPool(unsigned thread_count);
+		~WorkStealingPool();
+		
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+		
+		// Tasks submitted from a worker go to that worker's own queue.
+		void submit(std::function<void()> task);
+		// Blocks until every submitted task has finished.
+		void wait();
+		// Runs queued tasks on the calling thread until `done` returns true,
+		// so a task can wait for the tasks it submitted without holding up a
+		// worker. `done` is called with the pool locked and must not submit.
+		void help_until(const std::function<bool()>& done);
+		unsigned thread_count() const;
+	private:
+		struct Queue {
+			std::mutex mutex;
+			std::deque<std::function<void()>> tasks;
+		};
+		
+		void run(unsigned index);
+		bool take_task(unsigned index, std::function<void()>& task);
+		void finish_task();
+	private:
+		std::vector<std::unique_ptr<Queue>> _queues;
+		std::vector<std::thread> _threads;
+		
+		std::mutex _mutex;
+		std::condition_variable _task_queued;
+		std::condition_variable _all_done;
+		// Wakes helping threads when a task is queued or finishes.
+		std::condition_variable _helper_wakeup;
+		unsigned _helpers = 0;
+		size_t _queued = 0;
+		size_t _unfinished = 0;
+		unsigned _next_queue = 0;
+		bool _stopping = false;
+};
+
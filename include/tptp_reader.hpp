@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include <mutex>
+
+#include "formula.hpp"
+
+struct TptpFormula {
+	std::string name;
+	std::string role;
+	std::shared_ptr<Formula> formula;
+};
+
+struct TptpProblem {
+	std::vector<TptpFormula> formulas;
+	// Bytes parsed to read the problem. Included files the reader had
+	// already parsed for an earlier problem are not counted.
+	size_t bytes_read = 0;
+};
+
+// Reads TPTP problems in FOF syntax, with the files they include, into the
+// Formula hierarchy. cnf entries are accepted as well and closed universally.
+// Equations become complex atoms with the predicate `=`. Included files are
+// looked up relative to the directory of the including file and each of its
+// ancestors, then relative to $TPTP. Other TPTP languages (tff, thf, ...)
+// throw std::runtime_error, as does malformed input.
+//
+// Most of the library includes the same few axiom sets, so each included
+// file is parsed once per reader and shared by every problem that includes
+// it. A reader can be used from several threads at once.
+class TptpReader {
+	public:
+		TptpProblem read(const std::string& filename);
+	private:
+		void load(const std::string& filename, unsigned depth, std::vector<TptpFormula>& formulas, size_t& bytes_read);
+		std::shared_ptr<const std::vector<TptpFormula>> included(const std::string& filename, unsigned depth, size_t& bytes_read);
+	private:
+		std::mutex _mutex;
+		std::map<std::string, std::shared_ptr<const std::vector<TptpFormula>>> _included;
+};
+
+// Reads a single problem with a reader of its own.
+TptpProblem read_tptp_problem(const std::string& filename);
+
+// Goal for proving the problem's conjecture, or the named entry, from its
+// premises; see make_problem_goal.
+std::shared_ptr<Formula> read_tptp_goal(const std::string& filename, const std::string& conjecture_name = "");
+
@@ -1,18 +1,20 @@
-#include "atom.hpp"
+#include <algorithm>
 
-std::set<std::string> AtomicFormula::get_free_variable_names() const {
-	return get_variable_names();
-}
+#include "atom.hpp"
+#include "node_factory.hpp"
+#include "substitution.hpp"
 
 bool AtomicFormula::requires_parentheses() const {
 	return false;
 }
 
-std::set<std::string> LogicalConstant::get_variable_names() const {
-	return {};
+LogicalConstant::LogicalConstant(FormulaType type) {
+	_hash = hash_combine(static_cast<size_t>(type), 0);
+	_sequent_hash = sequent_hash_seed(static_cast<uint64_t>(type));
 }
 
-std::string True::to_string() const {
+std::string True::format(const BinderNames& binders) const {
+	(void) binders;
 	return "⊤ ";
 }
 
@@ -25,19 +27,25 @@ bool True::operator==(const True& other) const {
 	return true;
 }
 
-std::shared_ptr<Formula> True::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
+std::shared_ptr<Formula> True::substitute(const Substitution& substitution) const {
+	(void) substitution;
+	return self();
+}
+
+std::shared_ptr<Formula> True::abstract_var(const Symbol& var_name, unsigned index) const {
 	(void) var_name;
-	(void) term;
-	return std::make_shared<True>(*this);
+	(void) index;
+	return self();
 }
 
-std::shared_ptr<Formula> True::rename_var(const std::string& old_name, const std::string& new_name) const {
-	(void) old_name;
-	(void) new_name;
-	return std::make_shared<True>(*this);
+std::shared_ptr<Formula> True::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	(void) index;
+	(void) terms;
+	return self();
 }
 
-std::string False::to_string() const {
+std::string False::format(const BinderNames& binders) const {
+	(void) binders;
 	return "⊥ ";
 }
 
@@ -50,22 +58,39 @@ bool False::operator==(const False& other) const {
 	return true;
 }
 
-std::shared_ptr<Formula> False::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
+std::shared_ptr<Formula> False::substitute(const Substitution& substitution) const {
+	(void) substitution;
+	return self();
+}
+
+std::shared_ptr<Formula> False::abstract_var(const Symbol& var_name, unsigned index) const {
 	(void) var_name;
-	(void) term;
-	return std::make_shared<False>(*this);
+	(void) index;
+	return self();
 }
 
-std::shared_ptr<Formula> False::rename_var(const std::string& old_name, const std::string& new_name) const {
-	(void) old_name;
-	(void) new_name;
-	return std::make_shared<False>(*this);
+std::shared_ptr<Formula> False::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	(void) index;
+	(void) terms;
+	return self();
 }
 
-std::string SimpleAtom::to_string() const {
+Atom::Atom(FormulaType type, const Symbol& p)
+	:_predicate_symbol(p)
+{
+	_hash = hash_combine(static_cast<size_t>(type), p.id());
+	_sequent_hash = sequent_hash_combine(sequent_hash_seed(static_cast<uint64_t>(type)), p.id());
+}
+
+Symbol Atom::get_predicate_symbol() const {
 	return _predicate_symbol;
 }
 
+std::string SimpleAtom::format(const BinderNames& binders) const {
+	(void) binders;
+	return _predicate_symbol.name();
+}
+
 FormulaType SimpleAtom::type() const {
 	return FormulaType::SimpleAtom;
 }
@@ -74,31 +99,53 @@ bool SimpleAtom::operator==(const SimpleAtom& other) const {
 	return this->_predicate_symbol == other._predicate_symbol;
 }
 
-std::set<std::string> SimpleAtom::get_variable_names() const {
-	return {};
+std::shared_ptr<Formula> SimpleAtom::substitute(const Substitution& substitution) const {
+	(void) substitution;
+	return self();
 }
 
-std::shared_ptr<Formula> SimpleAtom::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
+std::shared_ptr<Formula> SimpleAtom::abstract_var(const Symbol& var_name, unsigned index) const {
 	(void) var_name;
-	(void) term;
-	return std::make_shared<SimpleAtom>(*this);
+	(void) index;
+	return self();
 }
 
-std::shared_ptr<Formula> SimpleAtom::rename_var(const std::string& old_name, const std::string& new_name) const {
-	(void) old_name;
-	(void) new_name;
-	return std::make_shared<SimpleAtom>(*this);
+std::shared_ptr<Formula> SimpleAtom::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	(void) index;
+	(void) terms;
+	return self();
+}
+
+ComplexAtom::ComplexAtom(const Symbol& p, const std::vector<std::shared_ptr<Term>>& terms)
+	:Atom(FormulaType::ComplexAtom, p), _terms(terms)
+{
+	std::vector<Symbol> variables;
+	
+	_sequent_hash = sequent_hash_combine(_sequent_hash, _terms.size());
+	
+	for (const auto& t : _terms) {
+		variables.insert(variables.end(), t->get_variable_names().begin(), t->get_variable_names().end());
+		_size += t->size();
+		_depth = std::max(_depth, t->depth() + 1);
+		_hash = hash_combine(_hash, t->hash());
+		_sequent_hash = sequent_hash_combine(_sequent_hash, t->sequent_hash());
+		_loose_depth = std::max(_loose_depth, t->loose_depth());
+	}
+	
+	_variable_names = VariableSet(std::move(variables));
+	
+	_free_variable_names = _variable_names;
 }
 
-std::string ComplexAtom::to_string() const {
+std::string ComplexAtom::format(const BinderNames& binders) const {
 	std::stringstream s;
 	
-	s << _predicate_symbol;
+	s << _predicate_symbol.name();
 	
 	s << "(";
 	
 	for (size_t i = 0; i < _terms.size(); i++) {
-		s << _terms[i]->to_string();
+		s << _terms[i]->format(binders);
 		if (i < _terms.size() - 1) {
 			s << ", ";
 		}
@@ -131,34 +178,49 @@ FormulaType ComplexAtom::type() const {
 	return FormulaType::ComplexAtom;
 }
 
-std::set<std::string> ComplexAtom::get_variable_names() const {
-	std::set<std::string> variable_names = {};
+const std::vector<std::shared_ptr<Term>>& ComplexAtom::get_terms() const {
+	return _terms;
+}
 
+std::shared_ptr<Formula> ComplexAtom::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_free_variable_names)) {
+		return self();
+	}
+	
+	std::vector<std::shared_ptr<Term>> new_terms = {};
+	
 	for (const auto& t : _terms) {
-		auto sub_vars = t->get_variable_names();
-		variable_names.insert(sub_vars.begin(), sub_vars.end());
+		new_terms.push_back(t->substitute(substitution));
 	}
 	
-	return variable_names;
+	return NodeFactory::make_complex_atom(_predicate_symbol, new_terms);
 }
 
-std::shared_ptr<Formula> ComplexAtom::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
+std::shared_ptr<Formula> ComplexAtom::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_free_variable_names.contains(var_name)) {
+		return self();
+	}
+	
 	std::vector<std::shared_ptr<Term>> new_terms = {};
 	
 	for (const auto& t : _terms) {
-		new_terms.push_back(t->replace(var_name, term));
+		new_terms.push_back(t->abstract_var(var_name, index));
 	}
 	
-	return std::make_shared<ComplexAtom>(_predicate_symbol, new_terms);
+	return NodeFactory::make_complex_atom(_predicate_symbol, new_terms);
 }
 
-std::shared_ptr<Formula> ComplexAtom::rename_var(const std::string& old_name, const std::string& new_name) const {
+std::shared_ptr<Formula> ComplexAtom::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
+	}
+	
 	std::vector<std::shared_ptr<Term>> new_terms = {};
 	
 	for (const auto& t : _terms) {
-		new_terms.push_back(t->rename_var(old_name, new_name));
+		new_terms.push_back(t->instantiate_bound(index, terms));
 	}
 	
-	return std::make_shared<ComplexAtom>(_predicate_symbol, new_terms);
+	return NodeFactory::make_complex_atom(_predicate_symbol, new_terms);
 }
 
@@ -15,6 +15,29 @@ std::vector<std::string> split_into_words(const std::string& input) {
     return words;
 }
 
+std::string join_words(const std::vector<std::string>& words, size_t first) {
+    std::string joined;
+    
+    for (size_t i = first; i < words.size(); i++) {
+        if (i > first) {
+            joined += " ";
+        }
+        joined += words[i];
+    }
+    
+    return joined;
+}
+
+std::string trim(const std::string& input) {
+    size_t first = input.find_first_not_of(' ');
+    
+    if (first == std::string::npos) {
+        return "";
+    }
+    
+    return input.substr(first, input.find_last_not_of(' ') - first + 1);
+}
+
 Command Command::parse_command(const std::string& user_input) {
 	std::vector<std::string> words = split_into_words(user_input);
 	
@@ -35,7 +58,7 @@ Command Command::parse_command(const std::string& user_input) {
 	}
 	
 	if (command_word == "apply") {
-		if (length == 1 or length > 3) {
+		if (length == 1) {
 			return {CommandType::UnknownCommand, {}};
 		}
 		
@@ -52,6 +75,12 @@ Command Command::parse_command(const std::string& user_input) {
 				return {CommandType::UnknownCommand, {}};
 			}
 			
+			// Only exI takes an argument: the instantiation term, which may
+			// span several words.
+			if (length > 3 and words[2] != "exI") {
+				return {CommandType::UnknownCommand, {}};
+			}
+			
 			if (words[2] == "notI") {
 				return {CommandType::RuleApplication, {Rule::NotI}};
 			} else if (words[2] == "conjI") {
@@ -67,7 +96,7 @@ Command Command::parse_command(const std::string& user_input) {
 			} else if (words[2] == "allI") {
 				return {CommandType::RuleApplication, {Rule::AllI}};
 			} else if (words[2] == "exI") {
-				return {CommandType::RuleApplication, {Rule::ExI}};
+				return {CommandType::RuleApplication, {Rule::ExI}, join_words(words, 3)};
 			} else if (words[2] == "ccontr") {
 				return {CommandType::RuleApplication, {Rule::Ccontr}};
 			} else if (words[2] == "classical") {
@@ -82,23 +111,55 @@ Command Command::parse_command(const std::string& user_input) {
 				return {CommandType::UnknownCommand, {}};
 			}
 			
-			if (words[2] == "notE") {
-				return {CommandType::RuleApplication, {Rule::NotE}};
-			} else if (words[2] == "conjE") {
-				return {CommandType::RuleApplication, {Rule::ConjE}};
-			} else if (words[2] == "disjE") {
-				return {CommandType::RuleApplication, {Rule::DisjE}};
-			} else if (words[2] == "impE") {
-				return {CommandType::RuleApplication, {Rule::ImpE}};
-			} else if (words[2] == "iffE") {
-				return {CommandType::RuleApplication, {Rule::IffE}};
-			} else if (words[2] == "allE") {
-				return {CommandType::RuleApplication, {Rule::AllE}};
-			} else if (words[2] == "exE") {
-				return {CommandType::RuleApplication, {Rule::ExE}};
+			// The assumption to eliminate can be chosen in brackets right after
+			// the rule name, by its position or by the assumption itself.
+			std::string rest = join_words(words, 2);
+			size_t name_end = rest.find_first_of("[ ");
+			std::string name = rest.substr(0, name_end);
+			std::string assumption;
+			
+			if (name_end != std::string::npos and rest[name_end] == '[') {
+				size_t close = rest.find(']', name_end);
+				
+				if (close == std::string::npos) {
+					return {CommandType::UnknownCommand, {}};
+				}
+				
+				assumption = trim(rest.substr(name_end + 1, close - name_end - 1));
+				name_end = close + 1;
+				
+				if (assumption.empty() or (name_end < rest.size() and rest[name_end] != ' ')) {
+					return {CommandType::UnknownCommand, {}};
+				}
 			}
 			
-			return {CommandType::UnknownCommand, {}};
+			std::string argument = name_end < rest.size() ? trim(rest.substr(name_end)) : "";
+			
+			if (!argument.empty() and name != "allE") {
+				return {CommandType::UnknownCommand, {}};
+			}
+			
+			std::optional<Rule> rule;
+			
+			if (name == "notE") {
+				rule = Rule::NotE;
+			} else if (name == "conjE") {
+				rule = Rule::ConjE;
+			} else if (name == "disjE") {
+				rule = Rule::DisjE;
+			} else if (name == "impE") {
+				rule = Rule::ImpE;
+			} else if (name == "iffE") {
+				rule = Rule::IffE;
+			} else if (name == "allE") {
+				rule = Rule::AllE;
+			} else if (name == "exE") {
+				rule = Rule::ExE;
+			} else {
+				return {CommandType::UnknownCommand, {}};
+			}
+			
+			return {CommandType::RuleApplication, rule, argument, assumption};
 		}
 		
 		return {CommandType::UnknownCommand, {}};
@@ -120,6 +181,36 @@ Command Command::parse_command(const std::string& user_input) {
 		}
 		
 		return {CommandType::HelpRequest, {}};
+	} else if (command_word == "undo") {
+		if (length > 1) {
+			return {CommandType::UnknownCommand, {}};
+		}
+		
+		return {CommandType::Undo, {}};
+	} else if (command_word == "redo") {
+		if (length > 1) {
+			return {CommandType::UnknownCommand, {}};
+		}
+		
+		return {CommandType::Redo, {}};
+	} else if (command_word == "checkpoint") {
+		if (length != 2) {
+			return {CommandType::UnknownCommand, {}};
+		}
+		
+		return {CommandType::Checkpoint, {}, words[1]};
+	} else if (command_word == "restore") {
+		if (length != 2) {
+			return {CommandType::UnknownCommand, {}};
+		}
+		
+		return {CommandType::Restore, {}, words[1]};
+	} else if (command_word == "auto") {
+		if (length > 2) {
+			return {CommandType::UnknownCommand, {}};
+		}
+		
+		return {CommandType::Auto, {}, length == 2 ? words[1] : ""};
 	} else if (command_word == "done") {
 		if (length > 1) {
 			return {CommandType::UnknownCommand, {}};
@@ -1,14 +1,30 @@
+#include <algorithm>
+
 #include "connective.hpp"
+#include "node_factory.hpp"
+#include "substitution.hpp"
 
 bool LogicalConnective::requires_parentheses() const {
 	return true;
 }
 
-std::string UnaryConnective::to_string() const {
+UnaryConnective::UnaryConnective(FormulaType type, const std::shared_ptr<Formula>& sub)
+	:_subformula(sub)
+{
+	_variable_names = sub->get_variable_names();
+	_free_variable_names = sub->get_free_variable_names();
+	_size = sub->size() + 1;
+	_depth = sub->depth() + 1;
+	_hash = hash_combine(static_cast<size_t>(type), sub->hash());
+	_sequent_hash = sequent_hash_combine(sequent_hash_seed(static_cast<uint64_t>(type)), sub->sequent_hash());
+	_loose_depth = sub->loose_depth();
+}
+
+std::string UnaryConnective::format(const BinderNames& binders) const {
 	if (_subformula->requires_parentheses()) {
-		return symbol() + " (" + _subformula->to_string() + ")";
+		return symbol() + " (" + _subformula->format(binders) + ")";
 	} else {
-		return symbol() + " " + _subformula->to_string();
+		return symbol() + " " + _subformula->format(binders);
 	}
 }
 
@@ -16,28 +32,34 @@ std::shared_ptr<Formula> UnaryConnective::get_subformula() const {
 	return _subformula;
 }
 
-std::set<std::string> UnaryConnective::get_variable_names() const {
-	return _subformula->get_variable_names();
+BinaryConnective::BinaryConnective(FormulaType type, const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r)
+	:_left_subformula(l), _right_subformula(r)
+{
+	_variable_names = l->get_variable_names();
+	_variable_names.insert(r->get_variable_names());
+	_free_variable_names = l->get_free_variable_names();
+	_free_variable_names.insert(r->get_free_variable_names());
+	_size = l->size() + r->size() + 1;
+	_depth = std::max(l->depth(), r->depth()) + 1;
+	_hash = hash_combine(hash_combine(static_cast<size_t>(type), l->hash()), r->hash());
+	_sequent_hash = sequent_hash_combine(sequent_hash_combine(sequent_hash_seed(static_cast<uint64_t>(type)), l->sequent_hash()), r->sequent_hash());
+	_loose_depth = std::max(l->loose_depth(), r->loose_depth());
 }
 
-std::set<std::string> UnaryConnective::get_free_variable_names() const {
-	return _subformula->get_free_variable_names();
-}
-
-std::string BinaryConnective::to_string() const {
+std::string BinaryConnective::format(const BinderNames& binders) const {
 	std::string left;
 	std::string right;
 	
 	if (_left_subformula->requires_parentheses()) {
-		left = "(" + _left_subformula->to_string() + ")";
+		left = "(" + _left_subformula->format(binders) + ")";
 	} else {
-		left = _left_subformula->to_string();
+		left = _left_subformula->format(binders);
 	}
 	
 	if (_right_subformula->requires_parentheses()) {
-		right = "(" + _right_subformula->to_string() + ")";
+		right = "(" + _right_subformula->format(binders) + ")";
 	} else {
-		right = _right_subformula->to_string();
+		right = _right_subformula->format(binders);
 	}
 
 	return left + " " + symbol() + " " + right;
@@ -51,24 +73,6 @@ std::shared_ptr<Formula> BinaryConnective::get_right_subformula() const {
 	return _right_subformula;
 }
 
-std::set<std::string> BinaryConnective::get_variable_names() const {
-	auto vars_left = _left_subformula->get_variable_names();
-	auto vars_right = _right_subformula->get_variable_names();
-	
-	vars_left.insert(vars_right.begin(), vars_right.end());
-	
-	return vars_left;
-}
-
-std::set<std::string> BinaryConnective::get_free_variable_names() const {
-	auto free_vars_left = _left_subformula->get_free_variable_names();
-	auto free_vars_right = _right_subformula->get_free_variable_names();
-	
-	free_vars_left.insert(free_vars_right.begin(), free_vars_right.end());
-	
-	return free_vars_left;
-}
-
 std::string Negation::symbol() const {
 	return "¬";
 }
@@ -81,12 +85,28 @@ bool Negation::operator==(const Negation& other) const {
 	return are_equal(this->_subformula, other._subformula);
 }
 
-std::shared_ptr<Formula> Negation::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
-	return std::make_shared<Negation>(_subformula->replace(var_name, term));
+std::shared_ptr<Formula> Negation::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_free_variable_names)) {
+		return self();
+	}
+	
+	return NodeFactory::make_negation(_subformula->substitute(substitution));
 }
 
-std::shared_ptr<Formula> Negation::rename_var(const std::string& old_name, const std::string& new_name) const {
-	return std::make_shared<Negation>(_subformula->rename_var(old_name, new_name));
+std::shared_ptr<Formula> Negation::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_free_variable_names.contains(var_name)) {
+		return self();
+	}
+	
+	return NodeFactory::make_negation(_subformula->abstract_var(var_name, index));
+}
+
+std::shared_ptr<Formula> Negation::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
+	}
+	
+	return NodeFactory::make_negation(_subformula->instantiate_bound(index, terms));
 }
 
 std::string Conjunction::symbol() const {
@@ -101,12 +121,28 @@ bool Conjunction::operator==(const Conjunction& other) const {
 	return are_equal(this->_left_subformula, other._left_subformula) and are_equal(this->_right_subformula, other._right_subformula);
 }
 
-std::shared_ptr<Formula> Conjunction::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
-	return std::make_shared<Conjunction>(_left_subformula->replace(var_name, term), _right_subformula->replace(var_name, term));
+std::shared_ptr<Formula> Conjunction::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_free_variable_names)) {
+		return self();
+	}
+	
+	return NodeFactory::make_conjunction(_left_subformula->substitute(substitution), _right_subformula->substitute(substitution));
 }
 
-std::shared_ptr<Formula> Conjunction::rename_var(const std::string& old_name, const std::string& new_name) const {
-	return std::make_shared<Conjunction>(_left_subformula->rename_var(old_name, new_name), _right_subformula->rename_var(old_name, new_name));
+std::shared_ptr<Formula> Conjunction::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_free_variable_names.contains(var_name)) {
+		return self();
+	}
+	
+	return NodeFactory::make_conjunction(_left_subformula->abstract_var(var_name, index), _right_subformula->abstract_var(var_name, index));
+}
+
+std::shared_ptr<Formula> Conjunction::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
+	}
+	
+	return NodeFactory::make_conjunction(_left_subformula->instantiate_bound(index, terms), _right_subformula->instantiate_bound(index, terms));
 }
 
 std::string Disjunction::symbol() const {
@@ -121,12 +157,28 @@ bool Disjunction::operator==(const Disjunction& other) const {
 	return are_equal(this->_left_subformula, other._left_subformula) and are_equal(this->_right_subformula, other._right_subformula);
 }
 
-std::shared_ptr<Formula> Disjunction::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
-	return std::make_shared<Disjunction>(_left_subformula->replace(var_name, term), _right_subformula->replace(var_name, term));
+std::shared_ptr<Formula> Disjunction::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_free_variable_names)) {
+		return self();
+	}
+	
+	return NodeFactory::make_disjunction(_left_subformula->substitute(substitution), _right_subformula->substitute(substitution));
 }
 
-std::shared_ptr<Formula> Disjunction::rename_var(const std::string& old_name, const std::string& new_name) const {
-	return std::make_shared<Disjunction>(_left_subformula->rename_var(old_name, new_name), _right_subformula->rename_var(old_name, new_name));
+std::shared_ptr<Formula> Disjunction::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_free_variable_names.contains(var_name)) {
+		return self();
+	}
+	
+	return NodeFactory::make_disjunction(_left_subformula->abstract_var(var_name, index), _right_subformula->abstract_var(var_name, index));
+}
+
+std::shared_ptr<Formula> Disjunction::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
+	}
+	
+	return NodeFactory::make_disjunction(_left_subformula->instantiate_bound(index, terms), _right_subformula->instantiate_bound(index, terms));
 }
 
 std::string Implication::symbol() const {
@@ -141,12 +193,28 @@ bool Implication::operator==(const Implication& other) const {
 	return are_equal(this->_left_subformula, other._left_subformula) and are_equal(this->_right_subformula, other._right_subformula);
 }
 
-std::shared_ptr<Formula> Implication::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
-	return std::make_shared<Implication>(_left_subformula->replace(var_name, term), _right_subformula->replace(var_name, term));
+std::shared_ptr<Formula> Implication::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_free_variable_names)) {
+		return self();
+	}
+	
+	return NodeFactory::make_implication(_left_subformula->substitute(substitution), _right_subformula->substitute(substitution));
+}
+
+std::shared_ptr<Formula> Implication::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_free_variable_names.contains(var_name)) {
+		return self();
+	}
+	
+	return NodeFactory::make_implication(_left_subformula->abstract_var(var_name, index), _right_subformula->abstract_var(var_name, index));
 }
 
-std::shared_ptr<Formula> Implication::rename_var(const std::string& old_name, const std::string& new_name) const {
-	return std::make_shared<Implication>(_left_subformula->rename_var(old_name, new_name), _right_subformula->rename_var(old_name, new_name));
+std::shared_ptr<Formula> Implication::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
+	}
+	
+	return NodeFactory::make_implication(_left_subformula->instantiate_bound(index, terms), _right_subformula->instantiate_bound(index, terms));
 }
 
 std::string Equivalence::symbol() const {
@@ -161,11 +229,27 @@ bool Equivalence::operator==(const Equivalence& other) const {
 	return are_equal(this->_left_subformula, other._left_subformula) and are_equal(this->_right_subformula, other._right_subformula);
 }
 
-std::shared_ptr<Formula> Equivalence::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
-	return std::make_shared<Equivalence>(_left_subformula->replace(var_name, term), _right_subformula->replace(var_name, term));
+std::shared_ptr<Formula> Equivalence::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_free_variable_names)) {
+		return self();
+	}
+	
+	return NodeFactory::make_equivalence(_left_subformula->substitute(substitution), _right_subformula->substitute(substitution));
 }
 
-std::shared_ptr<Formula> Equivalence::rename_var(const std::string& old_name, const std::string& new_name) const {
-	return std::make_shared<Equivalence>(_left_subformula->rename_var(old_name, new_name), _right_subformula->rename_var(old_name, new_name));
+std::shared_ptr<Formula> Equivalence::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_free_variable_names.contains(var_name)) {
+		return self();
+	}
+	
+	return NodeFactory::make_equivalence(_left_subformula->abstract_var(var_name, index), _right_subformula->abstract_var(var_name, index));
+}
+
+std::shared_ptr<Formula> Equivalence::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
+	}
+	
+	return NodeFactory::make_equivalence(_left_subformula->instantiate_bound(index, terms), _right_subformula->instantiate_bound(index, terms));
 }
 
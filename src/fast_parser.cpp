@@ -0,0 +1,471 @@
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+#include "fast_parser.hpp"
+#include "atom.hpp"
+#include "connective.hpp"
+#include "quantifier.hpp"
+#include "node_factory.hpp"
+#include "mapped_file.hpp"
+
+namespace {
+
+enum class Token {
+	End,
+	Variable,
+	Symbol,
+	True,
+	False,
+	Not,
+	And,
+	Or,
+	Implies,
+	Iff,
+	ForAll,
+	Exists,
+	Dot,
+	LeftParenthesis,
+	RightParenthesis,
+	Comma,
+	Invalid
+};
+
+// Parentheses and nested terms are handled recursively, everything else in
+// loops. Deeper nesting than this is rejected rather than risking the stack.
+const unsigned max_nesting = 10000;
+
+struct ParseError {
+	size_t offset;
+};
+
+class FastParser {
+	public:
+		FastParser(std::string_view input)
+			:_input(input)
+		{
+			next();
+		}
+		
+		std::shared_ptr<Formula> parse() {
+			auto formula = formula_rule();
+			expect(Token::End);
+			return formula;
+		}
+	private:
+		static bool is_identifier_char(char c) {
+			return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or (c >= '0' and c <= '9') or c == '_';
+		}
+		
+		bool is_digit_at(size_t position) const {
+			return position < _input.size() and _input[position] >= '0' and _input[position] <= '9';
+		}
+		
+		// Length of a name in TPTP spelling at the current position, or 0: a
+		// quoted name, a distinct object, a $ word or a number.
+		size_t tptp_name_length() const {
+			char c = _input[_position];
+			size_t end = _position + 1;
+			
+			if (c == '\'' or c == '"') {
+				while (end < _input.size() and _input[end] != c) {
+					if (_input[end] == '\\') {
+						if (end + 1 == _input.size() or _input[end + 1] == '\n') {
+							return 0;
+						}
+						
+						end++;
+					}
+					
+					end++;
+				}
+				
+				return end < _input.size() ? end + 1 - _position : 0;
+			}
+			
+			if (c == '$') {
+				if (end < _input.size() and _input[end] == '$') {
+					end++;
+				}
+				
+				size_t word = end;
+				
+				while (end < _input.size() and is_identifier_char(_input[end])) {
+					end++;
+				}
+				
+				return end > word ? end - _position : 0;
+			}
+			
+			if ((c == '+' or c == '-') and is_digit_at(end)) {
+				end++;
+			} else if (!is_digit_at(_position)) {
+				return 0;
+			}
+			
+			while (is_digit_at(end)) {
+				end++;
+			}
+			
+			if (end < _input.size() and (_input[end] == '.' or _input[end] == '/') and is_digit_at(end + 1)) {
+				end++;
+				
+				while (is_digit_at(end)) {
+					end++;
+				}
+			}
+			
+			if (end < _input.size() and (_input[end] == 'e' or _input[end] == 'E')) {
+				size_t digits = end + 1;
+				
+				if (digits < _input.size() and (_input[digits] == '+' or _input[digits] == '-')) {
+					digits++;
+				}
+				
+				if (is_digit_at(digits)) {
+					end = digits;
+					
+					while (is_digit_at(end)) {
+						end++;
+					}
+				}
+			}
+			
+			return end - _position;
+		}
+		
+		bool starts_with(std::string_view text) const {
+			return _input.substr(_position, text.size()) == text;
+		}
+		
+		// Mirrors lexer.lpp: the longest match wins and any other character
+		// is a token of its own, which the grammar then rejects.
+		void next() {
+			while (_position < _input.size() and (_input[_position] == ' ' or _input[_position] == '\t' or _input[_position] == '\n')) {
+				_position++;
+			}
+			
+			_token_start = _position;
+			
+			// The flex scanner reports a NUL byte as the end of input.
+			if (_position == _input.size() or _input[_position] == '\0') {
+				_token = Token::End;
+				return;
+			}
+			
+			char c = _input[_position];
+			
+			if ((c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z')) {
+				size_t end = _position + 1;
+				
+				while (end < _input.size() and is_identifier_char(_input[end])) {
+					end++;
+				}
+				
+				_text = _input.substr(_position, end - _position);
+				_position = end;
+				
+				if (_text == "True") {
+					_token = Token::True;
+				} else if (_text == "False") {
+					_token = Token::False;
+				} else {
+					_token = c >= 'a' and c <= 'z' ? Token::Symbol : Token::Variable;
+				}
+				
+				return;
+			}
+			
+			if (size_t length = tptp_name_length()) {
+				_text = _input.substr(_position, length);
+				_position += length;
+				_token = Token::Symbol;
+				return;
+			}
+			
+			if (starts_with("=>")) {
+				_position += 2;
+				_token = Token::Implies;
+				return;
+			}
+			
+			if (starts_with("<=>")) {
+				_position += 3;
+				_token = Token::Iff;
+				return;
+			}
+			
+			_position++;
+			
+			switch (c) {
+				case '~':
+					_token = Token::Not;
+					break;
+				case '&':
+					_token = Token::And;
+					break;
+				case '|':
+					_token = Token::Or;
+					break;
+				case '!':
+					_token = Token::ForAll;
+					break;
+				case '?':
+					_token = Token::Exists;
+					break;
+				case '.':
+					_token = Token::Dot;
+					break;
+				case '(':
+					_token = Token::LeftParenthesis;
+					break;
+				case ')':
+					_token = Token::RightParenthesis;
+					break;
+				case ',':
+					_token = Token::Comma;
+					break;
+				default:
+					_token = Token::Invalid;
+			}
+		}
+		
+		void expect(Token token) {
+			if (_token != token) {
+				throw ParseError{_token_start};
+			}
+		}
+		
+		void enter() {
+			if (++_nesting > max_nesting) {
+				throw ParseError{_token_start};
+			}
+		}
+		
+		void leave() {
+			_nesting--;
+		}
+		
+		Symbol symbol() const {
+			return Symbol(std::string(_text));
+		}
+		
+		// formula: (! VAR . | ? VAR .)* implication
+		std::shared_ptr<Formula> formula_rule() {
+			std::vector<std::pair<bool, Symbol>> binders;
+			
+			while (_token == Token::ForAll or _token == Token::Exists) {
+				bool for_all = _token == Token::ForAll;
+				next();
+				expect(Token::Variable);
+				Symbol var = symbol();
+				next();
+				expect(Token::Dot);
+				next();
+				binders.push_back({for_all, var});
+			}
+			
+			std::shared_ptr<Formula> formula = implication_rule();
+			
+			for (auto it = binders.rbegin(); it != binders.rend(); ++it) {
+				if (it->first) {
+					formula = NodeFactory::make_for_all(it->second, formula);
+				} else {
+					formula = NodeFactory::make_exists(it->second, formula);
+				}
+			}
+			
+			return formula;
+		}
+		
+		// implication: disjunction (=> disjunction)*, right associative
+		std::shared_ptr<Formula> implication_rule() {
+			std::vector<std::shared_ptr<Formula>> operands = {disjunction_rule()};
+			
+			while (_token == Token::Implies) {
+				next();
+				operands.push_back(disjunction_rule());
+			}
+			
+			std::shared_ptr<Formula> formula = operands.back();
+			
+			for (size_t i = operands.size() - 1; i > 0; i--) {
+				formula = NodeFactory::make_implication(operands[i - 1], formula);
+			}
+			
+			return formula;
+		}
+		
+		// disjunction: conjunction (| conjunction)*, right associative
+		std::shared_ptr<Formula> disjunction_rule() {
+			std::vector<std::shared_ptr<Formula>> operands = {conjunction_rule()};
+			
+			while (_token == Token::Or) {
+				next();
+				operands.push_back(conjunction_rule());
+			}
+			
+			std::shared_ptr<Formula> formula = operands.back();
+			
+			for (size_t i = operands.size() - 1; i > 0; i--) {
+				formula = NodeFactory::make_disjunction(operands[i - 1], formula);
+			}
+			
+			return formula;
+		}
+		
+		// conjunction: equivalence (& equivalence)*, right associative
+		std::shared_ptr<Formula> conjunction_rule() {
+			std::vector<std::shared_ptr<Formula>> operands = {equivalence_rule()};
+			
+			while (_token == Token::And) {
+				next();
+				operands.push_back(equivalence_rule());
+			}
+			
+			std::shared_ptr<Formula> formula = operands.back();
+			
+			for (size_t i = operands.size() - 1; i > 0; i--) {
+				formula = NodeFactory::make_conjunction(operands[i - 1], formula);
+			}
+			
+			return formula;
+		}
+		
+		// equivalence: negation (<=> negation)*, left associative
+		std::shared_ptr<Formula> equivalence_rule() {
+			std::shared_ptr<Formula> formula = negation_rule();
+			
+			while (_token == Token::Iff) {
+				next();
+				formula = NodeFactory::make_equivalence(formula, negation_rule());
+			}
+			
+			return formula;
+		}
+		
+		// negation: ~* subformula
+		std::shared_ptr<Formula> negation_rule() {
+			unsigned negations = 0;
+			
+			while (_token == Token::Not) {
+				next();
+				negations++;
+			}
+			
+			std::shared_ptr<Formula> formula = subformula_rule();
+			
+			for (unsigned i = 0; i < negations; i++) {
+				formula = NodeFactory::make_negation(formula);
+			}
+			
+			return formula;
+		}
+		
+		// subformula: atomic_formula | ( formula )
+		std::shared_ptr<Formula> subformula_rule() {
+			if (_token != Token::LeftParenthesis) {
+				return atomic_formula_rule();
+			}
+			
+			enter();
+			next();
+			
+			std::shared_ptr<Formula> formula = formula_rule();
+			
+			expect(Token::RightParenthesis);
+			next();
+			leave();
+			
+			return formula;
+		}
+		
+		// atomic_formula: True | False | SYMBOL | SYMBOL ( term_list )
+		std::shared_ptr<Formula> atomic_formula_rule() {
+			if (_token == Token::True) {
+				next();
+				return NodeFactory::make_true();
+			}
+			
+			if (_token == Token::False) {
+				next();
+				return NodeFactory::make_false();
+			}
+			
+			expect(Token::Symbol);
+			Symbol p = symbol();
+			next();
+			
+			if (_token != Token::LeftParenthesis) {
+				return NodeFactory::make_simple_atom(p);
+			}
+			
+			return NodeFactory::make_complex_atom(p, term_list_rule());
+		}
+		
+		// term: SYMBOL | VAR | SYMBOL ( term_list )
+		std::shared_ptr<Term> term_rule() {
+			if (_token == Token::Variable) {
+				Symbol var = symbol();
+				next();
+				return NodeFactory::make_variable(var);
+			}
+			
+			expect(Token::Symbol);
+			Symbol f = symbol();
+			next();
+			
+			if (_token != Token::LeftParenthesis) {
+				return NodeFactory::make_constant(f);
+			}
+			
+			return NodeFactory::make_complex_term(f, term_list_rule());
+		}
+		
+		// ( term (, term)* ), including the parentheses
+		std::vector<std::shared_ptr<Term>> term_list_rule() {
+			enter();
+			next();
+			
+			std::vector<std::shared_ptr<Term>> terms = {term_rule()};
+			
+			while (_token == Token::Comma) {
+				next();
+				terms.push_back(term_rule());
+			}
+			
+			expect(Token::RightParenthesis);
+			next();
+			leave();
+			
+			return terms;
+		}
+	private:
+		std::string_view _input;
+		size_t _position = 0;
+		size_t _token_start = 0;
+		Token _token = Token::End;
+		std::string_view _text;
+		unsigned _nesting = 0;
+};
+
+}
+
+std::shared_ptr<Formula> fast_parse_formula(std::string_view input) {
+	try {
+		return FastParser(input).parse();
+	} catch (const ParseError& e) {
+		throw std::runtime_error("Formula not parsed correctly at offset " + std::to_string(e.offset) + "!");
+	}
+}
+
+std::shared_ptr<Formula> fast_parse_formula_file(const std::string& filename) {
+	MappedFile file(filename);
+	
+	try {
+		return FastParser(file.contents()).parse();
+	} catch (const ParseError& e) {
+		throw std::runtime_error("Formula not parsed correctly in file: " + filename + " at offset " + std::to_string(e.offset));
+	}
+}
+
@@ -2,72 +2,42 @@
 #include "atom.hpp"
 #include "connective.hpp"
 #include "quantifier.hpp"
+#include "node_factory.hpp"
+#include "substitution.hpp"
 
 bool are_equal(const std::shared_ptr<Formula>& f1, const std::shared_ptr<Formula>& f2) {
+	if (f1 == f2) {
+		return true;
+	}
+	
 	FormulaType type = f1->type();
-
-	if (type != f2->type()) {
+	
+	if (type != f2->type() or f1->hash() != f2->hash()) {
 		return false;
 	}
 	
 	switch (type) {
-		case FormulaType::True: {
-			auto t1 = std::dynamic_pointer_cast<True>(f1);
-			auto t2 = std::dynamic_pointer_cast<True>(f2);
-			return *t1 == *t2;
-		}
-		case FormulaType::False: {
-			auto x1 = std::dynamic_pointer_cast<False>(f1);
-			auto x2 = std::dynamic_pointer_cast<False>(f2);
-			return *x1 == *x2;
-		}
-		case FormulaType::SimpleAtom: {
-			auto s1 = std::dynamic_pointer_cast<SimpleAtom>(f1);
-			auto s2 = std::dynamic_pointer_cast<SimpleAtom>(f2);
-			return *s1 == *s2;
-		}
-		case FormulaType::ComplexAtom: {
-			auto c1 = std::dynamic_pointer_cast<ComplexAtom>(f1);
-			auto c2 = std::dynamic_pointer_cast<ComplexAtom>(f2);
-			return *c1 == *c2;
-		}
-		case FormulaType::Negation: {
-			auto n1 = std::dynamic_pointer_cast<Negation>(f1);
-			auto n2 = std::dynamic_pointer_cast<Negation>(f2);
-			return *n1 == *n2;
-		}
-		case FormulaType::Conjunction: {
-			auto c1 = std::dynamic_pointer_cast<Conjunction>(f1);
-			auto c2 = std::dynamic_pointer_cast<Conjunction>(f2);
-			return *c1 == *c2;
-		}
-		case FormulaType::Disjunction: {
-			auto d1 = std::dynamic_pointer_cast<Disjunction>(f1);
-			auto d2 = std::dynamic_pointer_cast<Disjunction>(f2);
-			return *d1 == *d2;
-		}
-		case FormulaType::Implication: {
-			auto i1 = std::dynamic_pointer_cast<Implication>(f1);
-			auto i2 = std::dynamic_pointer_cast<Implication>(f2);
-			return *i1 == *i2;
-		}
-		case FormulaType::Equivalence: {
-			auto e1 = std::dynamic_pointer_cast<Equivalence>(f1);
-			auto e2 = std::dynamic_pointer_cast<Equivalence>(f2);
-			return *e1 == *e2;
-		}
-		case FormulaType::ForAll: {
-			auto fa1 = std::dynamic_pointer_cast<ForAll>(f1);
-			auto fa2 = std::dynamic_pointer_cast<ForAll>(f2);
-			return *fa1 == *fa2;
-		}
-		case FormulaType::Exists: {
-			auto ex1 = std::dynamic_pointer_cast<Exists>(f1);
-			auto ex2 = std::dynamic_pointer_cast<Exists>(f2);
-			return *ex1 == *ex2;
-		}
+		case FormulaType::True:
+		case FormulaType::False:
+		case FormulaType::SimpleAtom:
+		case FormulaType::ComplexAtom:
+			return false;
+		case FormulaType::Negation:
+			return *std::static_pointer_cast<Negation>(f1) == *std::static_pointer_cast<Negation>(f2);
+		case FormulaType::Conjunction:
+			return *std::static_pointer_cast<Conjunction>(f1) == *std::static_pointer_cast<Conjunction>(f2);
+		case FormulaType::Disjunction:
+			return *std::static_pointer_cast<Disjunction>(f1) == *std::static_pointer_cast<Disjunction>(f2);
+		case FormulaType::Implication:
+			return *std::static_pointer_cast<Implication>(f1) == *std::static_pointer_cast<Implication>(f2);
+		case FormulaType::Equivalence:
+			return *std::static_pointer_cast<Equivalence>(f1) == *std::static_pointer_cast<Equivalence>(f2);
+		case FormulaType::ForAll:
+			return *std::static_pointer_cast<ForAll>(f1) == *std::static_pointer_cast<ForAll>(f2);
+		case FormulaType::Exists:
+			return *std::static_pointer_cast<Exists>(f1) == *std::static_pointer_cast<Exists>(f2);
 	}
-
+	
 	return false;
 }
 
@@ -76,12 +46,62 @@ std::ostream& operator<<(std::ostream& out, const Formula& formula) {
 	return out;
 }
 
-std::string Formula::generate_new_variable_name(const std::string& old_name, const std::set<std::string>& used_names) {
-	std::string new_name = old_name;
+std::string Formula::to_string() const {
+	return format({});
+}
+
+std::shared_ptr<Formula> Formula::replace(const Symbol& var_name, const std::shared_ptr<Term>& term) const {
+	return substitute({{var_name, term}});
+}
+
+std::shared_ptr<Formula> Formula::rename_var(const Symbol& old_name, const Symbol& new_name) const {
+	return substitute({{old_name, NodeFactory::make_variable(new_name)}});
+}
+
+const VariableSet& Formula::get_variable_names() const {
+	return _variable_names;
+}
+
+const VariableSet& Formula::get_free_variable_names() const {
+	return _free_variable_names;
+}
+
+unsigned Formula::size() const {
+	return _size;
+}
+
+unsigned Formula::depth() const {
+	return _depth;
+}
+
+size_t Formula::hash() const {
+	return _hash;
+}
+
+const SequentHash& Formula::sequent_hash() const {
+	return _sequent_hash;
+}
+
+unsigned Formula::loose_depth() const {
+	return _loose_depth;
+}
+
+std::shared_ptr<Formula> Formula::self() const {
+	return std::const_pointer_cast<Formula>(shared_from_this());
+}
+
+Symbol Formula::generate_new_variable_name(const Symbol& old_name, const VariableSet& used_names) {
+	return generate_new_variable_name(old_name, [&used_names](const Symbol& name) {
+		return used_names.contains(name);
+	});
+}
+
+Symbol Formula::generate_new_variable_name(const Symbol& old_name, const std::function<bool(const Symbol&)>& is_used) {
+	Symbol new_name = old_name;
 	
 	unsigned i = 1;
-	while (used_names.find(new_name) != used_names.end()) {
-		new_name = old_name + std::to_string(i++);
+	while (is_used(new_name)) {
+		new_name = Symbol(old_name.name() + std::to_string(i++));
 	}
 	
 	return new_name;
@@ -0,0 +1,587 @@
+#include <fstream>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "formula_cache.hpp"
+#include "mapped_file.hpp"
+#include "node_factory.hpp"
+#include "atom.hpp"
+#include "connective.hpp"
+#include "quantifier.hpp"
+
+namespace {
+
+const char cache_magic[8] = {'P', 'R', 'V', 'C', 'A', 'C', 'H', 'E'};
+const uint32_t cache_version = 1;
+
+enum class NodeKind : uint8_t {
+	Variable,
+	Constant,
+	ComplexTerm,
+	BoundVariable,
+	True,
+	False,
+	SimpleAtom,
+	ComplexAtom,
+	Negation,
+	Conjunction,
+	Disjunction,
+	Implication,
+	Equivalence,
+	ForAll,
+	Exists
+};
+
+// The file is the header, the symbol offsets, the nodes and the children, all
+// four-byte aligned, followed by the selection and the symbol names.
+struct CacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t selection_size;
+	uint64_t source_size;
+	int64_t source_mtime;
+	uint64_t source_hash;
+	uint32_t symbol_count;
+	uint32_t symbol_bytes;
+	uint32_t node_count;
+	uint32_t child_count;
+};
+
+// `value` is a symbol index, or the index of a bound variable.
+struct CacheNode {
+	NodeKind kind;
+	uint8_t padding[3];
+	uint32_t value;
+	uint32_t first_child;
+	uint32_t child_count;
+};
+
+bool is_term(NodeKind kind) {
+	return kind <= NodeKind::BoundVariable;
+}
+
+class CacheWriter {
+	public:
+		uint32_t add(const std::shared_ptr<Formula>& formula) {
+			auto it = _indices.find(formula.get());
+			
+			if (it != _indices.end()) {
+				return it->second;
+			}
+			
+			CacheNode node = {};
+			std::vector<uint32_t> children;
+			
+			switch (formula->type()) {
+				case FormulaType::True:
+					node.kind = NodeKind::True;
+					break;
+				case FormulaType::False:
+					node.kind = NodeKind::False;
+					break;
+				case FormulaType::SimpleAtom:
+					node.kind = NodeKind::SimpleAtom;
+					node.value = symbol(std::static_pointer_cast<SimpleAtom>(formula)->get_predicate_symbol());
+					break;
+				case FormulaType::ComplexAtom: {
+					auto atom = std::static_pointer_cast<ComplexAtom>(formula);
+					node.kind = NodeKind::ComplexAtom;
+					node.value = symbol(atom->get_predicate_symbol());
+					for (const auto& t : atom->get_terms()) {
+						children.push_back(add(t));
+					}
+					break;
+				}
+				case FormulaType::Negation:
+					node.kind = NodeKind::Negation;
+					children.push_back(add(std::static_pointer_cast<Negation>(formula)->get_subformula()));
+					break;
+				case FormulaType::Conjunction:
+				case FormulaType::Disjunction:
+				case FormulaType::Implication:
+				case FormulaType::Equivalence: {
+					auto connective = std::static_pointer_cast<BinaryConnective>(formula);
+					node.kind = binary_kind(formula->type());
+					children.push_back(add(connective->get_left_subformula()));
+					children.push_back(add(connective->get_right_subformula()));
+					break;
+				}
+				case FormulaType::ForAll:
+				case FormulaType::Exists: {
+					auto quantifier = std::static_pointer_cast<Quantifier>(formula);
+					node.kind = formula->type() == FormulaType::ForAll ? NodeKind::ForAll : NodeKind::Exists;
+					node.value = symbol(quantifier->get_variable_name());
+					children.push_back(add(quantifier->get_subformula()));
+					break;
+				}
+			}
+			
+			return push(formula.get(), node, children);
+		}
+		
+		void write(std::ostream& out, const CacheKey& key) const {
+			CacheHeader header = {};
+			std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+			header.version = cache_version;
+			header.selection_size = key.selection.size();
+			header.source_size = key.source_size;
+			header.source_mtime = key.source_mtime;
+			header.source_hash = key.source_hash;
+			header.symbol_count = _symbol_names.size();
+			header.node_count = _nodes.size();
+			header.child_count = _children.size();
+			
+			std::vector<uint32_t> offsets = {0};
+			std::string names;
+			
+			for (const auto& name : _symbol_names) {
+				names += name;
+				offsets.push_back(names.size());
+			}
+			
+			header.symbol_bytes = names.size();
+			
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint32_t));
+			out.write(reinterpret_cast<const char*>(_nodes.data()), _nodes.size() * sizeof(CacheNode));
+			out.write(reinterpret_cast<const char*>(_children.data()), _children.size() * sizeof(uint32_t));
+			out.write(key.selection.data(), key.selection.size());
+			out.write(names.data(), names.size());
+		}
+	private:
+		uint32_t add(const std::shared_ptr<Term>& term) {
+			auto it = _indices.find(term.get());
+			
+			if (it != _indices.end()) {
+				return it->second;
+			}
+			
+			CacheNode node = {};
+			std::vector<uint32_t> children;
+			
+			switch (term->type()) {
+				case TermType::Variable:
+					node.kind = NodeKind::Variable;
+					node.value = symbol(std::static_pointer_cast<Variable>(term)->get_name());
+					break;
+				case TermType::Constant:
+					node.kind = NodeKind::Constant;
+					node.value = symbol(std::static_pointer_cast<Constant>(term)->get_name());
+					break;
+				case TermType::BoundVariable:
+					node.kind = NodeKind::BoundVariable;
+					node.value = std::static_pointer_cast<BoundVariable>(term)->get_index();
+					break;
+				case TermType::ComplexTerm: {
+					auto complex = std::static_pointer_cast<ComplexTerm>(term);
+					node.kind = NodeKind::ComplexTerm;
+					node.value = symbol(complex->get_function_symbol());
+					for (const auto& t : complex->get_subterms()) {
+						children.push_back(add(t));
+					}
+					break;
+				}
+			}
+			
+			return push(term.get(), node, children);
+		}
+		
+		static NodeKind binary_kind(FormulaType type) {
+			switch (type) {
+				case FormulaType::Conjunction:
+					return NodeKind::Conjunction;
+				case FormulaType::Disjunction:
+					return NodeKind::Disjunction;
+				case FormulaType::Implication:
+					return NodeKind::Implication;
+				default:
+					return NodeKind::Equivalence;
+			}
+		}
+		
+		uint32_t symbol(const Symbol& s) {
+			auto it = _symbols.find(s);
+			
+			if (it != _symbols.end()) {
+				return it->second;
+			}
+			
+			uint32_t index = _symbol_names.size();
+			_symbol_names.push_back(s.name());
+			_symbols.emplace(s, index);
+			return index;
+		}
+		
+		uint32_t push(const void* key, CacheNode node, const std::vector<uint32_t>& children) {
+			node.first_child = _children.size();
+			node.child_count = children.size();
+			_children.insert(_children.end(), children.begin(), children.end());
+			
+			uint32_t index = _nodes.size();
+			_nodes.push_back(node);
+			_indices.emplace(key, index);
+			return index;
+		}
+	private:
+		std::unordered_map<const void*, uint32_t> _indices;
+		std::unordered_map<Symbol, uint32_t> _symbols;
+		std::vector<std::string> _symbol_names;
+		std::vector<CacheNode> _nodes;
+		std::vector<uint32_t> _children;
+};
+
+struct InvalidCache {};
+
+class CacheReader {
+	public:
+		CacheReader(std::string_view data, const CacheHeader& header)
+			:_header(header)
+		{
+			const char* p = data.data() + sizeof(CacheHeader);
+			
+			_offsets = reinterpret_cast<const uint32_t*>(p);
+			p += (header.symbol_count + 1) * sizeof(uint32_t);
+			_nodes = reinterpret_cast<const CacheNode*>(p);
+			p += header.node_count * sizeof(CacheNode);
+			_children = reinterpret_cast<const uint32_t*>(p);
+			p += header.child_count * sizeof(uint32_t);
+			p += header.selection_size;
+			_names = p;
+		}
+		
+		std::shared_ptr<Formula> read() {
+			if (_header.node_count == 0) {
+				throw InvalidCache();
+			}
+			
+			read_symbols();
+			
+			_terms.resize(_header.node_count);
+			_formulas.resize(_header.node_count);
+			
+			for (uint32_t i = 0; i < _header.node_count; i++) {
+				read_node(i);
+			}
+			
+			auto root = _formulas[_header.node_count - 1];
+			
+			if (!root) {
+				throw InvalidCache();
+			}
+			
+			return root;
+		}
+	private:
+		void read_symbols() {
+			_symbols.reserve(_header.symbol_count);
+			
+			for (uint32_t i = 0; i < _header.symbol_count; i++) {
+				uint32_t begin = _offsets[i];
+				uint32_t end = _offsets[i + 1];
+				
+				if (begin > end or end > _header.symbol_bytes) {
+					throw InvalidCache();
+				}
+				
+				_symbols.emplace_back(std::string(_names + begin, end - begin));
+			}
+		}
+		
+		const Symbol& symbol(const CacheNode& node) const {
+			if (node.value >= _symbols.size()) {
+				throw InvalidCache();
+			}
+			
+			return _symbols[node.value];
+		}
+		
+		void expect_children(const CacheNode& node, uint32_t count) const {
+			if (node.child_count != count) {
+				throw InvalidCache();
+			}
+		}
+		
+		// Children must come before their parent, so every node refers only to
+		// nodes that have already been built.
+		uint32_t child(const CacheNode& node, uint32_t i, uint32_t parent) const {
+			uint32_t index = _children[node.first_child + i];
+			
+			if (index >= parent) {
+				throw InvalidCache();
+			}
+			
+			return index;
+		}
+		
+		const std::shared_ptr<Term>& term_child(const CacheNode& node, uint32_t i, uint32_t parent) const {
+			const auto& term = _terms[child(node, i, parent)];
+			
+			if (!term) {
+				throw InvalidCache();
+			}
+			
+			return term;
+		}
+		
+		const std::shared_ptr<Formula>& formula_child(const CacheNode& node, uint32_t i, uint32_t parent) const {
+			const auto& formula = _formulas[child(node, i, parent)];
+			
+			if (!formula) {
+				throw InvalidCache();
+			}
+			
+			return formula;
+		}
+		
+		std::vector<std::shared_ptr<Term>> term_children(const CacheNode& node, uint32_t parent) const {
+			std::vector<std::shared_ptr<Term>> terms;
+			terms.reserve(node.child_count);
+			
+			for (uint32_t i = 0; i < node.child_count; i++) {
+				terms.push_back(term_child(node, i, parent));
+			}
+			
+			return terms;
+		}
+		
+		void read_node(uint32_t i) {
+			const CacheNode& node = _nodes[i];
+			
+			if (uint64_t(node.first_child) + node.child_count > _header.child_count) {
+				throw InvalidCache();
+			}
+			
+			if (is_term(node.kind)) {
+				_terms[i] = read_term(node, i);
+			} else {
+				_formulas[i] = read_formula(node, i);
+			}
+		}
+		
+		std::shared_ptr<Term> read_term(const CacheNode& node, uint32_t i) const {
+			switch (node.kind) {
+				case NodeKind::Variable:
+					expect_children(node, 0);
+					return NodeFactory::make_variable(symbol(node));
+				case NodeKind::Constant:
+					expect_children(node, 0);
+					return NodeFactory::make_constant(symbol(node));
+				case NodeKind::BoundVariable:
+					expect_children(node, 0);
+					return NodeFactory::make_bound_variable(node.value);
+				default:
+					if (node.child_count == 0) {
+						throw InvalidCache();
+					}
+					return NodeFactory::make_complex_term(symbol(node), term_children(node, i));
+			}
+		}
+		
+		std::shared_ptr<Formula> read_formula(const CacheNode& node, uint32_t i) const {
+			switch (node.kind) {
+				case NodeKind::True:
+					expect_children(node, 0);
+					return NodeFactory::make_true();
+				case NodeKind::False:
+					expect_children(node, 0);
+					return NodeFactory::make_false();
+				case NodeKind::SimpleAtom:
+					expect_children(node, 0);
+					return NodeFactory::make_simple_atom(symbol(node));
+				case NodeKind::ComplexAtom:
+					if (node.child_count == 0) {
+						throw InvalidCache();
+					}
+					return NodeFactory::make_complex_atom(symbol(node), term_children(node, i));
+				case NodeKind::Negation:
+					expect_children(node, 1);
+					return NodeFactory::make_negation(formula_child(node, 0, i));
+				case NodeKind::Conjunction:
+					expect_children(node, 2);
+					return NodeFactory::make_conjunction(formula_child(node, 0, i), formula_child(node, 1, i));
+				case NodeKind::Disjunction:
+					expect_children(node, 2);
+					return NodeFactory::make_disjunction(formula_child(node, 0, i), formula_child(node, 1, i));
+				case NodeKind::Implication:
+					expect_children(node, 2);
+					return NodeFactory::make_implication(formula_child(node, 0, i), formula_child(node, 1, i));
+				case NodeKind::Equivalence:
+					expect_children(node, 2);
+					return NodeFactory::make_equivalence(formula_child(node, 0, i), formula_child(node, 1, i));
+				case NodeKind::ForAll:
+					expect_children(node, 1);
+					return NodeFactory::make_for_all_scope(symbol(node), formula_child(node, 0, i));
+				case NodeKind::Exists:
+					expect_children(node, 1);
+					return NodeFactory::make_exists_scope(symbol(node), formula_child(node, 0, i));
+				default:
+					throw InvalidCache();
+			}
+		}
+	private:
+		const CacheHeader& _header;
+		const uint32_t* _offsets;
+		const CacheNode* _nodes;
+		const uint32_t* _children;
+		const char* _names;
+		std::vector<Symbol> _symbols;
+		std::vector<std::shared_ptr<Term>> _terms;
+		std::vector<std::shared_ptr<Formula>> _formulas;
+};
+
+uint64_t hash_contents(std::string_view contents) {
+	// 64-bit FNV-1a.
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	
+	for (char c : contents) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+	}
+	
+	return hash;
+}
+
+// The header of a valid cache file, or nullptr.
+const CacheHeader* cache_header(std::string_view data) {
+	if (data.size() < sizeof(CacheHeader)) {
+		return nullptr;
+	}
+	
+	const CacheHeader* header = reinterpret_cast<const CacheHeader*>(data.data());
+	
+	if (std::memcmp(header->magic, cache_magic, sizeof(cache_magic)) != 0 or header->version != cache_version) {
+		return nullptr;
+	}
+	
+	uint64_t size = sizeof(CacheHeader);
+	size += (uint64_t(header->symbol_count) + 1) * sizeof(uint32_t);
+	size += uint64_t(header->node_count) * sizeof(CacheNode);
+	size += uint64_t(header->child_count) * sizeof(uint32_t);
+	size += header->selection_size;
+	size += header->symbol_bytes;
+	
+	if (size != data.size()) {
+		return nullptr;
+	}
+	
+	return header;
+}
+
+std::string_view cache_selection(std::string_view data, const CacheHeader& header) {
+	return data.substr(data.size() - header.symbol_bytes - header.selection_size, header.selection_size);
+}
+
+std::shared_ptr<Formula> read_cache(std::string_view data, const CacheHeader& header) {
+	try {
+		return CacheReader(data, header).read();
+	} catch (const InvalidCache&) {
+		return nullptr;
+	}
+}
+
+}
+
+void write_formula_cache(const std::string& filename, const std::shared_ptr<Formula>& formula, const CacheKey& key) {
+	CacheWriter writer;
+	writer.add(formula);
+	
+	// Written under another name and renamed, so a reader never sees a
+	// partially written file.
+	std::string temporary = filename + ".tmp" + std::to_string(getpid());
+	
+	{
+		std::ofstream out(temporary, std::ios::binary);
+		
+		if (!out) {
+			throw std::runtime_error("Error opening file: " + temporary);
+		}
+		
+		writer.write(out, key);
+		
+		if (!out) {
+			std::remove(temporary.c_str());
+			throw std::runtime_error("Error writing file: " + temporary);
+		}
+	}
+	
+	if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+		std::remove(temporary.c_str());
+		throw std::runtime_error("Error writing file: " + filename);
+	}
+}
+
+std::shared_ptr<Formula> read_formula_cache(const std::string& filename, const CacheKey& key) {
+	if (access(filename.c_str(), R_OK) != 0) {
+		return nullptr;
+	}
+	
+	MappedFile file(filename);
+	std::string_view data = file.contents();
+	const CacheHeader* header = cache_header(data);
+	
+	if (header == nullptr or header->source_size != key.source_size or header->source_hash != key.source_hash or cache_selection(data, *header) != key.selection) {
+		return nullptr;
+	}
+	
+	return read_cache(data, *header);
+}
+
+std::shared_ptr<Formula> load_cached_formula(const std::string& source, const std::string& selection, const std::function<std::shared_ptr<Formula>()>& load) {
+	std::string cache = source + ".cache";
+	
+	struct stat source_stat;
+	
+	if (stat(source.c_str(), &source_stat) != 0) {
+		throw std::runtime_error("Error opening file: " + source);
+	}
+	
+	CacheKey key;
+	key.source_size = source_stat.st_size;
+	key.source_mtime = int64_t(source_stat.st_mtim.tv_sec) * 1000000000 + source_stat.st_mtim.tv_nsec;
+	key.selection = selection;
+	
+	// An unchanged size and modification time are trusted without reading
+	// the source. Otherwise the contents decide.
+	if (access(cache.c_str(), R_OK) == 0) {
+		MappedFile file(cache);
+		std::string_view data = file.contents();
+		const CacheHeader* header = cache_header(data);
+		
+		if (header != nullptr and cache_selection(data, *header) == selection and header->source_size == key.source_size) {
+			bool fresh = header->source_mtime == key.source_mtime;
+			
+			if (!fresh) {
+				MappedFile source_file(source);
+				fresh = header->source_hash == hash_contents(source_file.contents());
+			}
+			
+			if (fresh) {
+				auto formula = read_cache(data, *header);
+				
+				if (formula) {
+					return formula;
+				}
+			}
+		}
+	}
+	
+	{
+		MappedFile source_file(source);
+		key.source_hash = hash_contents(source_file.contents());
+	}
+	
+	auto formula = load();
+	
+	try {
+		write_formula_cache(cache, formula, key);
+	} catch (const std::runtime_error&) {
+	}
+	
+	return formula;
+}
+
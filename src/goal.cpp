@@ -1,28 +1,34 @@
 #include <algorithm>
+#include <unordered_map>
 
 #include "goal.hpp"
 #include "atom.hpp"
 #include "connective.hpp"
 #include "quantifier.hpp"
+#include "node_factory.hpp"
 
 std::string Goal::to_string() const {
-	if (_solved) {
-		return "<solved goal>";
-	}
-	
 	std::string body = body_to_string();
 	
 	if (_meta_variables.empty()) {
 		return body;
 	}
-
+	
 	std::stringstream s;
 	
 	s << "∧ ";
 	
-	for (auto it = _meta_variables.begin(); it != _meta_variables.end(); it++) {
-		s << *it;
-		if (std::next(it) != _meta_variables.end()) {
+	std::vector<std::string> meta_variable_names = {};
+	
+	for (const auto& v : _meta_variables) {
+		meta_variable_names.push_back(v.name());
+	}
+	
+	std::sort(meta_variable_names.begin(), meta_variable_names.end());
+	
+	for (size_t i = 0; i < meta_variable_names.size(); i++) {
+		s << meta_variable_names[i];
+		if (i < meta_variable_names.size() - 1) {
 			s << " ";
 		}
 	}
@@ -43,14 +49,14 @@ std::string Goal::body_to_string() const {
 	}
 	
 	if (num_assumptions == 1) {
-		s << *_assumptions[0];
+		s << *_assumptions.begin()->second;
 	} else {
 		s << "[";
-		for (size_t i = 0; i < num_assumptions; i++) {
-			s << *_assumptions[i];
-			if (i < num_assumptions - 1) {
+		for (auto it = _assumptions.begin(); it != _assumptions.end(); ++it) {
+			if (it != _assumptions.begin()) {
 				s << ", ";
 			}
+			s << *it->second;
 		}
 		s << "]";
 	}
@@ -65,339 +71,610 @@ void Goal::set_target(const std::shared_ptr<Formula>& formula) {
 	_target_formula = formula;
 }
 
+std::shared_ptr<Formula> Goal::get_target() const {
+	return _target_formula;
+}
+
+std::vector<std::shared_ptr<Formula>> Goal::get_assumptions() const {
+	std::vector<std::shared_ptr<Formula>> assumptions;
+	assumptions.reserve(_assumptions.size());
+	
+	for (const auto& entry : _assumptions) {
+		assumptions.push_back(entry.second);
+	}
+	
+	return assumptions;
+}
+
+std::optional<unsigned> Goal::get_assumption_position(const std::shared_ptr<Formula>& formula) const {
+	unsigned position = 0;
+	
+	for (const auto& entry : _assumptions) {
+		if (are_equal(entry.second, formula)) {
+			return position;
+		}
+		
+		position++;
+	}
+	
+	return std::nullopt;
+}
+
 void Goal::add_assumption(const std::shared_ptr<Formula>& formula) {
-	_assumptions.push_back(formula);
+	if (has_assumption(formula)) {
+		return;
+	}
+	
+	track_assumption(_next_assumption_key++, formula);
+}
+
+void Goal::remove_assumption(unsigned key) {
+	auto entry = _assumptions.find(key);
+	
+	if (entry == nullptr) {
+		throw std::runtime_error("No assumption with key " + std::to_string(key) + "!");
+	}
+	
+	// Copied first: erasing the entry may release the only reference to it.
+	auto assumption = entry->second;
+	
+	untrack_assumption(key, assumption);
+}
+
+std::optional<unsigned> Goal::find_assumption(FormulaType type, std::optional<unsigned> position) const {
+	if (position) {
+		if (*position >= _assumptions.size()) {
+			return std::nullopt;
+		}
+		
+		const auto& entry = _assumptions.nth(*position);
+		
+		if (entry.second->type() != type) {
+			return std::nullopt;
+		}
+		
+		return entry.first;
+	}
+	
+	auto it = _assumption_index.lower_bound({type, 0});
+	
+	if (it == _assumption_index.end() or it->first != type) {
+		return std::nullopt;
+	}
+	
+	return it->second;
+}
+
+bool Goal::has_assumption(const std::shared_ptr<Formula>& formula) const {
+	size_t hash = formula->hash();
+	
+	for (auto it = _assumption_hashes.lower_bound({hash, 0}); it != _assumption_hashes.end() and it->first == hash; ++it) {
+		if (are_equal(_assumptions.at(it->second), formula)) {
+			return true;
+		}
+	}
+	
+	return false;
 }
 
-void Goal::remove_assumption(unsigned index) {
-	if (index < _assumptions.size()) {
-		_assumptions.erase(_assumptions.begin() + index);
+void Goal::track_assumption(unsigned key, const std::shared_ptr<Formula>& assumption) {
+	_assumptions.insert(key, assumption);
+	_assumption_index.insert({assumption->type(), key});
+	_assumption_hashes.insert({assumption->hash(), key});
+	
+	if (mentions_meta_variable(*assumption)) {
+		_meta_assumption_keys.insert(key);
 	} else {
-		throw std::runtime_error("Index out of bounds!");
+		_ground_assumption_hash += assumption->sequent_hash();
+	}
+	
+	for (const auto& v : assumption->get_free_variable_names()) {
+		auto entry = _assumption_free_variable_counts.find(v);
+		unsigned count = entry == nullptr ? 0 : entry->second;
+		
+		_assumption_free_variable_counts.insert(v, count + 1);
+	}
+}
+
+void Goal::untrack_assumption(unsigned key, const std::shared_ptr<Formula>& assumption) {
+	_assumptions.erase(key);
+	_assumption_index.erase({assumption->type(), key});
+	_assumption_hashes.erase({assumption->hash(), key});
+	
+	if (_meta_assumption_keys.contains(key)) {
+		_meta_assumption_keys.erase(key);
+	} else {
+		_ground_assumption_hash -= assumption->sequent_hash();
+	}
+	
+	for (const auto& v : assumption->get_free_variable_names()) {
+		unsigned count = _assumption_free_variable_counts.at(v);
+		
+		if (count == 1) {
+			_assumption_free_variable_counts.erase(v);
+		} else {
+			_assumption_free_variable_counts.insert(v, count - 1);
+		}
 	}
 }
 
-std::set<std::string> Goal::get_free_vars_in_assumptions() const {
-	std::set<std::string> free_vars = {};
+bool Goal::is_used_variable(const Symbol& name) const {
+	return _meta_variables.contains(name)
+		or _assumption_free_variable_counts.contains(name)
+		or _target_formula->get_free_variable_names().contains(name);
+}
+
+bool Goal::mentions_meta_variable(const Formula& formula) const {
+	if (_meta_variables.empty()) {
+		return false;
+	}
 	
-	for (const auto& assumption : _assumptions) {
-		auto free_vars_assumption = assumption->get_free_variable_names();
-		free_vars.insert(free_vars_assumption.begin(), free_vars_assumption.end());
+	for (const auto& v : formula.get_free_variable_names()) {
+		if (_meta_variables.contains(v)) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+// The target and the assumptions mentioning meta-variables are hashed with the
+// meta-variables numbered in order of first occurrence: in the target, then in
+// those assumptions, sorted by their hash with all meta-variables numbered
+// alike. Only such assumptions that are equal up to meta-variables can leave
+// equivalent goals with different hashes.
+SequentHash Goal::canonical_hash() const {
+	const uint64_t target_tag = 1;
+	
+	SequentHash hash = _ground_assumption_hash;
+	bool meta_target = mentions_meta_variable(*_target_formula);
+	
+	if (_meta_assumption_keys.empty() and !meta_target) {
+		hash += tag_hash(_target_formula->sequent_hash(), target_tag);
+		return hash;
+	}
+	
+	VariableNumbering anonymous = [this](const Symbol& name) -> std::optional<unsigned> {
+		if (!_meta_variables.contains(name)) {
+			return std::nullopt;
+		}
+		
+		return 0;
+	};
+	
+	std::unordered_map<Symbol, unsigned> numbered;
+	
+	VariableNumbering numbering = [this, &numbered](const Symbol& name) -> std::optional<unsigned> {
+		if (!_meta_variables.contains(name)) {
+			return std::nullopt;
+		}
+		
+		return numbered.emplace(name, numbered.size()).first->second;
+	};
+	
+	hash += tag_hash(meta_target ? hash_formula(*_target_formula, numbering) : _target_formula->sequent_hash(), target_tag);
+	
+	std::vector<std::pair<SequentHash, const Formula*>> assumptions;
+	
+	for (unsigned key : _meta_assumption_keys) {
+		const Formula* assumption = _assumptions.at(key).get();
+		assumptions.push_back({hash_formula(*assumption, anonymous), assumption});
+	}
+	
+	std::stable_sort(assumptions.begin(), assumptions.end(), [](const auto& a1, const auto& a2) {
+		return std::make_pair(a1.first.low, a1.first.high) < std::make_pair(a2.first.low, a2.first.high);
+	});
+	
+	for (const auto& assumption : assumptions) {
+		hash += hash_formula(*assumption.second, numbering);
+	}
+	
+	return hash;
+}
+
+VariableSet Goal::get_free_vars_in_assumptions() const {
+	VariableSet free_vars = {};
+	
+	for (const auto& entry : _assumption_free_variable_counts) {
+		free_vars.insert(entry.first);
 	}
 	
 	return free_vars;
 }
 
-std::set<std::string> Goal::get_free_vars_in_target_formula() const {
+VariableSet Goal::get_free_vars_in_target_formula() const {
 	return _target_formula->get_free_variable_names();
 }
 
-std::set<std::string> Goal::get_free_variables() const {
+VariableSet Goal::get_free_variables() const {
 	auto free_vars = get_free_vars_in_assumptions();
 	auto free_vars_target = get_free_vars_in_target_formula();
 	
-	free_vars.insert(free_vars_target.begin(), free_vars_target.end());
+	free_vars.insert(free_vars_target);
 	
 	return free_vars;
 }
 
-RuleStatus Goal::apply_assumption() {
-	for (const auto& assumption : _assumptions) {
-		if (are_equal(assumption, _target_formula)) {
-			_solved = true;
-			return RuleStatus::Success;
-		}
+Successors Goal::apply(const RuleApplication& application) const {
+	const auto& position = application.assumption;
+	const auto& terms = application.terms;
+	
+	switch (application.rule) {
+		case Rule::Assumption:
+			return apply_assumption();
+		case Rule::NotI:
+			return apply_rule_not_i();
+		case Rule::NotE:
+			return apply_erule_not_e(position);
+		case Rule::ConjI:
+			return apply_rule_conj_i();
+		case Rule::ConjE:
+			return apply_erule_conj_e(position);
+		case Rule::DisjI1:
+			return apply_rule_disj_i_1();
+		case Rule::DisjI2:
+			return apply_rule_disj_i_2();
+		case Rule::DisjE:
+			return apply_erule_disj_e(position);
+		case Rule::ImpI:
+			return apply_rule_imp_i();
+		case Rule::ImpE:
+			return apply_erule_imp_e(position);
+		case Rule::IffI:
+			return apply_rule_iff_i();
+		case Rule::IffE:
+			return apply_erule_iff_e(position);
+		case Rule::AllI:
+			return apply_rule_all_i();
+		case Rule::AllE:
+			return apply_erule_all_e(position, terms);
+		case Rule::ExI:
+			return apply_rule_ex_i(terms);
+		case Rule::ExE:
+			return apply_erule_ex_e(position);
+		case Rule::Ccontr:
+			return apply_rule_ccontr();
+		case Rule::Classical:
+			return apply_rule_classical();
 	}
 	
-	return RuleStatus::Failure;
+	return {RuleStatus::Failure, {}};
 }
 
-RuleStatus Goal::apply_rule_not_i() {
-	if (_target_formula->type() != FormulaType::Negation) {
-		return RuleStatus::Failure;
+Successors Goal::apply_assumption() const {
+	if (!has_assumption(_target_formula)) {
+		return {RuleStatus::Failure, {}};
 	}
 	
-	auto target_negation = std::dynamic_pointer_cast<Negation>(_target_formula);
+	return {RuleStatus::Success, {}};
+}
+
+Successors Goal::apply_rule_not_i() const {
+	if (_target_formula->type() != FormulaType::Negation) {
+		return {RuleStatus::Failure, {}};
+	}
 	
-	auto subformula = target_negation->get_subformula();
+	auto target_negation = std::static_pointer_cast<Negation>(_target_formula);
 	
-	_target_formula = std::make_shared<False>();
+	Goal goal = *this;
 	
-	add_assumption(subformula);
+	goal.set_target(NodeFactory::make_false());
+	goal.add_assumption(target_negation->get_subformula());
 	
-	return RuleStatus::Success;
+	return {RuleStatus::Success, {goal}};
 }
 
-RuleStatus Goal::apply_erule_not_e() {
-	for (size_t i = 0; i < _assumptions.size(); i++) {
-		if (_assumptions[i]->type() == FormulaType::Negation) {
-			auto negation = std::dynamic_pointer_cast<Negation>(_assumptions[i]);
-			
-			auto subformula = negation->get_subformula();
-			
-			remove_assumption(i);
-			
-			set_target(subformula);
-			
-			return RuleStatus::Success;
-		}
+Successors Goal::apply_erule_not_e(std::optional<unsigned> position) const {
+	auto key = find_assumption(FormulaType::Negation, position);
+	
+	if (!key) {
+		return {RuleStatus::Failure, {}};
 	}
 	
-	return RuleStatus::Failure;
+	auto negation = std::static_pointer_cast<Negation>(_assumptions.at(*key));
+	
+	Goal goal = *this;
+	
+	goal.remove_assumption(*key);
+	goal.set_target(negation->get_subformula());
+	
+	return {RuleStatus::Success, {goal}};
 }
 
-ConjIResult Goal::apply_rule_conj_i() {
+Successors Goal::apply_rule_conj_i() const {
 	if (_target_formula->type() != FormulaType::Conjunction) {
-		return {RuleStatus::Failure, NULL, NULL};
+		return {RuleStatus::Failure, {}};
 	}
 	
-	auto target_conjunction = std::dynamic_pointer_cast<Conjunction>(_target_formula);
+	auto target_conjunction = std::static_pointer_cast<Conjunction>(_target_formula);
 	
-	auto left = target_conjunction->get_left_subformula();
-	auto right = target_conjunction->get_right_subformula();
+	Goal left_goal = *this;
+	Goal right_goal = *this;
 	
-	return {RuleStatus::Success, left, right};
+	left_goal.set_target(target_conjunction->get_left_subformula());
+	right_goal.set_target(target_conjunction->get_right_subformula());
+	
+	return {RuleStatus::Success, {left_goal, right_goal}};
 }
 
-RuleStatus Goal::apply_erule_conj_e() {
-	for (size_t i = 0; i < _assumptions.size(); i++) {
-		if (_assumptions[i]->type() == FormulaType::Conjunction) {
-			auto conjunction = std::dynamic_pointer_cast<Conjunction>(_assumptions[i]);
-			
-			auto left = conjunction->get_left_subformula();
-			auto right = conjunction->get_right_subformula();
-			
-			remove_assumption(i);
-			
-			add_assumption(left);
-			add_assumption(right);
-			
-			return RuleStatus::Success;
-		}
+Successors Goal::apply_erule_conj_e(std::optional<unsigned> position) const {
+	auto key = find_assumption(FormulaType::Conjunction, position);
+	
+	if (!key) {
+		return {RuleStatus::Failure, {}};
 	}
 	
-	return RuleStatus::Failure;
+	auto conjunction = std::static_pointer_cast<Conjunction>(_assumptions.at(*key));
+	
+	Goal goal = *this;
+	
+	goal.remove_assumption(*key);
+	goal.add_assumption(conjunction->get_left_subformula());
+	goal.add_assumption(conjunction->get_right_subformula());
+	
+	return {RuleStatus::Success, {goal}};
 }
 
-RuleStatus Goal::apply_rule_disj_i_1() {
+Successors Goal::apply_rule_disj_i_1() const {
 	if (_target_formula->type() != FormulaType::Disjunction) {
-		return RuleStatus::Failure;
+		return {RuleStatus::Failure, {}};
 	}
 	
-	auto target_disjunction = std::dynamic_pointer_cast<Disjunction>(_target_formula);
+	auto target_disjunction = std::static_pointer_cast<Disjunction>(_target_formula);
+	
+	Goal goal = *this;
 	
-	_target_formula = target_disjunction->get_left_subformula();
+	goal.set_target(target_disjunction->get_left_subformula());
 	
-	return RuleStatus::Success;
+	return {RuleStatus::Success, {goal}};
 }
 
-RuleStatus Goal::apply_rule_disj_i_2() {
+Successors Goal::apply_rule_disj_i_2() const {
 	if (_target_formula->type() != FormulaType::Disjunction) {
-		return RuleStatus::Failure;
+		return {RuleStatus::Failure, {}};
 	}
 	
-	auto target_disjunction = std::dynamic_pointer_cast<Disjunction>(_target_formula);
+	auto target_disjunction = std::static_pointer_cast<Disjunction>(_target_formula);
 	
-	_target_formula = target_disjunction->get_right_subformula();
+	Goal goal = *this;
 	
-	return RuleStatus::Success;
+	goal.set_target(target_disjunction->get_right_subformula());
+	
+	return {RuleStatus::Success, {goal}};
 }
 
-DisjEResult Goal::apply_erule_disj_e() {
-	for (size_t i = 0; i < _assumptions.size(); i++) {
-		if (_assumptions[i]->type() == FormulaType::Disjunction) {
-			auto disjunction = std::dynamic_pointer_cast<Disjunction>(_assumptions[i]);
-			
-			auto left = disjunction->get_left_subformula();
-			auto right = disjunction->get_right_subformula();
-			
-			remove_assumption(i);
-			
-			return {RuleStatus::Success, left, right};
-		}
+Successors Goal::apply_erule_disj_e(std::optional<unsigned> position) const {
+	auto key = find_assumption(FormulaType::Disjunction, position);
+	
+	if (!key) {
+		return {RuleStatus::Failure, {}};
 	}
 	
-	return {RuleStatus::Failure, NULL, NULL};
+	auto disjunction = std::static_pointer_cast<Disjunction>(_assumptions.at(*key));
+	
+	Goal left_goal = *this;
+	
+	left_goal.remove_assumption(*key);
+	
+	Goal right_goal = left_goal;
+	
+	left_goal.add_assumption(disjunction->get_left_subformula());
+	right_goal.add_assumption(disjunction->get_right_subformula());
+	
+	return {RuleStatus::Success, {left_goal, right_goal}};
 }
 
-RuleStatus Goal::apply_rule_imp_i() {
+Successors Goal::apply_rule_imp_i() const {
 	if (_target_formula->type() != FormulaType::Implication) {
-		return RuleStatus::Failure;
+		return {RuleStatus::Failure, {}};
 	}
 	
-	auto target_implication = std::dynamic_pointer_cast<Implication>(_target_formula);
+	auto target_implication = std::static_pointer_cast<Implication>(_target_formula);
 	
-	auto left = target_implication->get_left_subformula();
-	auto right = target_implication->get_right_subformula();
+	Goal goal = *this;
 	
-	_target_formula = right;
+	goal.set_target(target_implication->get_right_subformula());
+	goal.add_assumption(target_implication->get_left_subformula());
 	
-	add_assumption(left);
-	
-	return RuleStatus::Success;
+	return {RuleStatus::Success, {goal}};
 }
 
-ImpEResult Goal::apply_erule_imp_e() {
-	for (size_t i = 0; i < _assumptions.size(); i++) {
-		if (_assumptions[i]->type() == FormulaType::Implication) {
-			auto implication = std::dynamic_pointer_cast<Implication>(_assumptions[i]);
-			
-			auto left = implication->get_left_subformula();
-			auto right = implication->get_right_subformula();
-			
-			remove_assumption(i);
-			
-			return {RuleStatus::Success, left, right};
-		}
+Successors Goal::apply_erule_imp_e(std::optional<unsigned> position) const {
+	auto key = find_assumption(FormulaType::Implication, position);
+	
+	if (!key) {
+		return {RuleStatus::Failure, {}};
 	}
 	
-	return {RuleStatus::Failure, NULL, NULL};
+	auto implication = std::static_pointer_cast<Implication>(_assumptions.at(*key));
+	
+	Goal premise_goal = *this;
+	
+	premise_goal.remove_assumption(*key);
+	
+	Goal conclusion_goal = premise_goal;
+	
+	premise_goal.set_target(implication->get_left_subformula());
+	conclusion_goal.add_assumption(implication->get_right_subformula());
+	
+	return {RuleStatus::Success, {premise_goal, conclusion_goal}};
 }
 
-IffIResult Goal::apply_rule_iff_i() {
+Successors Goal::apply_rule_iff_i() const {
 	if (_target_formula->type() != FormulaType::Equivalence) {
-		return {RuleStatus::Failure, NULL, NULL};
+		return {RuleStatus::Failure, {}};
 	}
 	
-	auto target_equivalence = std::dynamic_pointer_cast<Equivalence>(_target_formula);
+	auto target_equivalence = std::static_pointer_cast<Equivalence>(_target_formula);
 	
 	auto left = target_equivalence->get_left_subformula();
 	auto right = target_equivalence->get_right_subformula();
 	
-	return {RuleStatus::Success, left, right};
+	Goal left_to_right = *this;
+	Goal right_to_left = *this;
+	
+	left_to_right.add_assumption(left);
+	left_to_right.set_target(right);
+	
+	right_to_left.add_assumption(right);
+	right_to_left.set_target(left);
+	
+	return {RuleStatus::Success, {left_to_right, right_to_left}};
 }
 
-RuleStatus Goal::apply_erule_iff_e() {
-	for (size_t i = 0; i < _assumptions.size(); i++) {
-		if (_assumptions[i]->type() == FormulaType::Equivalence) {
-			auto equivalence = std::dynamic_pointer_cast<Equivalence>(_assumptions[i]);
-			
-			auto left = equivalence->get_left_subformula();
-			auto right = equivalence->get_right_subformula();
-			
-			remove_assumption(i);
-			
-			auto left_to_right = std::make_shared<Implication>(left, right);
-			auto right_to_left = std::make_shared<Implication>(right, left);
-			
-			add_assumption(left_to_right);
-			add_assumption(right_to_left);
-			
-			return RuleStatus::Success;
-		}
+Successors Goal::apply_erule_iff_e(std::optional<unsigned> position) const {
+	auto key = find_assumption(FormulaType::Equivalence, position);
+	
+	if (!key) {
+		return {RuleStatus::Failure, {}};
 	}
 	
-	return RuleStatus::Failure;
+	auto equivalence = std::static_pointer_cast<Equivalence>(_assumptions.at(*key));
+	
+	auto left = equivalence->get_left_subformula();
+	auto right = equivalence->get_right_subformula();
+	
+	Goal goal = *this;
+	
+	goal.remove_assumption(*key);
+	goal.add_assumption(NodeFactory::make_implication(left, right));
+	goal.add_assumption(NodeFactory::make_implication(right, left));
+	
+	return {RuleStatus::Success, {goal}};
 }
 
-RuleStatus Goal::apply_rule_all_i() {
+Successors Goal::apply_rule_all_i() const {
 	if (_target_formula->type() != FormulaType::ForAll) {
-		return RuleStatus::Failure;
+		return {RuleStatus::Failure, {}};
 	}
 	
-	auto target_forall_formula = std::dynamic_pointer_cast<ForAll>(_target_formula);
-	
-	std::set<std::string> used_variables = _meta_variables;
-	std::set<std::string> free_variables = get_free_variables();
-	used_variables.insert(free_variables.begin(), free_variables.end());
+	auto target_forall_formula = std::static_pointer_cast<ForAll>(_target_formula);
 	
-	std::string old_variable_name = target_forall_formula->get_variable_name();
-	std::string new_variable_name = Formula::generate_new_variable_name(old_variable_name, used_variables);
+	Symbol old_variable_name = target_forall_formula->get_variable_name();
+	Symbol new_variable_name = Formula::generate_new_variable_name(old_variable_name, [this](const Symbol& name) {
+		return is_used_variable(name);
+	});
 	
-	auto subformula = target_forall_formula->get_subformula();
+	Goal goal = *this;
 	
-	auto new_target = subformula->rename_var(old_variable_name, new_variable_name);
+	goal.set_target(target_forall_formula->instantiate(NodeFactory::make_variable(new_variable_name)));
+	goal._meta_variables.insert(new_variable_name);
 	
-	set_target(new_target);
-	
-	_meta_variables.insert(new_variable_name);
-	
-	return RuleStatus::Success;
+	return {RuleStatus::Success, {goal}};
 }
 
-RuleStatus Goal::apply_erule_all_e(const std::shared_ptr<Term>& replacement_term) {
-	for (size_t i = 0; i < _assumptions.size(); i++) {
-		if (_assumptions[i]->type() == FormulaType::ForAll) {
-			auto forall_formula = std::dynamic_pointer_cast<ForAll>(_assumptions[i]);
-			
-			auto quantified_variable = forall_formula->get_variable_name();
-			auto subformula = forall_formula->get_subformula();
-			
-			auto new_assumption = subformula->replace(quantified_variable, replacement_term);
-			
-			remove_assumption(i);
-			add_assumption(new_assumption);
-			
-			return RuleStatus::Success;
+// Without a position, the first universal assumption that can be instantiated
+// with all the terms is taken.
+Successors Goal::apply_erule_all_e(std::optional<unsigned> position, const std::vector<std::shared_ptr<Term>>& replacement_terms) const {
+	std::vector<unsigned> candidates;
+	
+	if (position) {
+		auto key = find_assumption(FormulaType::ForAll, position);
+		
+		if (key) {
+			candidates.push_back(*key);
+		}
+	} else {
+		auto it = _assumption_index.lower_bound({FormulaType::ForAll, 0});
+		
+		for (; it != _assumption_index.end() and it->first == FormulaType::ForAll; ++it) {
+			candidates.push_back(it->second);
 		}
 	}
 	
-	return RuleStatus::Failure;
+	for (unsigned key : candidates) {
+		auto forall_formula = std::static_pointer_cast<ForAll>(_assumptions.at(key));
+		
+		auto new_assumption = forall_formula->instantiate(replacement_terms);
+		
+		if (!new_assumption) {
+			continue;
+		}
+		
+		Goal goal = *this;
+		
+		goal.remove_assumption(key);
+		goal.add_assumption(new_assumption);
+		
+		return {RuleStatus::Success, {goal}};
+	}
+	
+	return {RuleStatus::Failure, {}};
 }
 
-RuleStatus Goal::apply_rule_ex_i(const std::shared_ptr<Term>& replacement_term) {
+Successors Goal::apply_rule_ex_i(const std::vector<std::shared_ptr<Term>>& replacement_terms) const {
 	if (_target_formula->type() != FormulaType::Exists) {
-		return RuleStatus::Failure;
+		return {RuleStatus::Failure, {}};
 	}
 	
-	auto target_exists_formula = std::dynamic_pointer_cast<Exists>(_target_formula);
+	auto target_exists_formula = std::static_pointer_cast<Exists>(_target_formula);
 	
-	auto quantified_variable = target_exists_formula->get_variable_name();
-	auto subformula = target_exists_formula->get_subformula();
+	auto new_target = target_exists_formula->instantiate(replacement_terms);
 	
-	auto new_target = subformula->replace(quantified_variable, replacement_term);
+	if (!new_target) {
+		return {RuleStatus::Failure, {}};
+	}
+	
+	Goal goal = *this;
 	
-	set_target(new_target);
+	goal.set_target(new_target);
 	
-	return RuleStatus::Success;
+	return {RuleStatus::Success, {goal}};
 }
 
-RuleStatus Goal::apply_erule_ex_e() {
-	for (size_t i = 0; i < _assumptions.size(); i++) {
-		if (_assumptions[i]->type() == FormulaType::Exists) {
-			auto exists_formula = std::dynamic_pointer_cast<Exists>(_assumptions[i]);
-			
-			std::set<std::string> used_variables = _meta_variables;
-			std::set<std::string> free_variables = get_free_variables();
-			used_variables.insert(free_variables.begin(), free_variables.end());
-			
-			std::string old_variable_name = exists_formula->get_variable_name();
-			std::string new_variable_name = Formula::generate_new_variable_name(old_variable_name, used_variables);
-			
-			auto subformula = exists_formula->get_subformula();
-			
-			auto new_assumption = subformula->rename_var(old_variable_name, new_variable_name);
-			
-			remove_assumption(i);
-			add_assumption(new_assumption);
-			
-			_meta_variables.insert(new_variable_name);
-			
-			return RuleStatus::Success;
-		}
+Successors Goal::apply_erule_ex_e(std::optional<unsigned> position) const {
+	auto key = find_assumption(FormulaType::Exists, position);
+	
+	if (!key) {
+		return {RuleStatus::Failure, {}};
 	}
 	
-	return RuleStatus::Failure;
+	auto exists_formula = std::static_pointer_cast<Exists>(_assumptions.at(*key));
+	
+	Symbol old_variable_name = exists_formula->get_variable_name();
+	Symbol new_variable_name = Formula::generate_new_variable_name(old_variable_name, [this](const Symbol& name) {
+		return is_used_variable(name);
+	});
+	
+	Goal goal = *this;
+	
+	// A meta-variable first, so the new assumption is tracked as mentioning it.
+	goal._meta_variables.insert(new_variable_name);
+	goal.remove_assumption(*key);
+	goal.add_assumption(exists_formula->instantiate(NodeFactory::make_variable(new_variable_name)));
+	
+	return {RuleStatus::Success, {goal}};
 }
 
-RuleStatus Goal::apply_rule_ccontr() {
-	add_assumption(std::make_shared<Negation>(_target_formula));
+Successors Goal::apply_rule_ccontr() const {
+	Goal goal = *this;
 	
-	set_target(std::make_shared<False>());
+	goal.add_assumption(NodeFactory::make_negation(_target_formula));
+	goal.set_target(NodeFactory::make_false());
 	
-	return RuleStatus::Success;
+	return {RuleStatus::Success, {goal}};
 }
 
-RuleStatus Goal::apply_rule_classical() {
-	add_assumption(std::make_shared<Negation>(_target_formula));
+Successors Goal::apply_rule_classical() const {
+	Goal goal = *this;
+	
+	goal.add_assumption(NodeFactory::make_negation(_target_formula));
 	
-	return RuleStatus::Success;
+	return {RuleStatus::Success, {goal}};
 }
 
 void Goal::shift_assumptions(unsigned n) {
 	if (n > 0 && !_assumptions.empty()) {
 		n %= _assumptions.size();
-		std::rotate(_assumptions.begin(), _assumptions.begin() + n, _assumptions.end());
+		
+		// Moving an assumption to the back only gives it a fresh key.
+		for (unsigned i = 0; i < n; i++) {
+			auto first = _assumptions.begin();
+			auto formula = first->second;
+			
+			remove_assumption(first->first);
+			add_assumption(formula);
+		}
 	}
 }
 
@@ -1,22 +1,145 @@
 #include <iostream>
+#include <fstream>
 #include <memory>
 
 #include "formula.hpp"
 #include "prover.hpp"
+#include "problem_reader.hpp"
+#include "tptp_reader.hpp"
+#include "formula_cache.hpp"
+#include "proof_search.hpp"
 
 extern std::shared_ptr<Formula> parse_formula(const std::string& filename);
 
+namespace {
+
+// The argument of -j: a positive number of threads.
+unsigned parse_threads(const std::string& argument, const std::string& usage) {
+	if (argument.empty() or argument.size() > 9 or argument.find_first_not_of("0123456789") != std::string::npos) {
+		throw std::invalid_argument(usage);
+	}
+	
+	unsigned threads = std::stoul(argument);
+	
+	if (threads == 0) {
+		throw std::invalid_argument(usage);
+	}
+	
+	return threads;
+}
+
+}
+
 int main(int argc, char** argv) {
 	try {
 		std::shared_ptr<Formula> formula;
 		
-		if (argc != 2) {
-			throw std::invalid_argument(std::string("Usage: ") + argv[0] + " <filename>");
+		std::string usage = std::string("Usage: ") + argv[0] + " [--script <proof_path> [--verbose] | [--auto] [-j <threads>]] [--tptp] [--conjecture <name>] [--cache] <filename>";
+		
+		std::string formula_path;
+		std::string script_path;
+		std::string conjecture_name;
+		bool verbose = false;
+		bool tptp = false;
+		bool cache = false;
+		bool auto_prove = false;
+		unsigned threads = 1;
+		
+		for (int i = 1; i < argc; i++) {
+			std::string argument = argv[i];
+			
+			if (argument == "--script") {
+				if (i + 1 == argc) {
+					throw std::invalid_argument(usage);
+				}
+				
+				script_path = argv[++i];
+			} else if (argument == "--conjecture") {
+				if (i + 1 == argc) {
+					throw std::invalid_argument(usage);
+				}
+				
+				conjecture_name = argv[++i];
+			} else if (argument == "--tptp") {
+				tptp = true;
+			} else if (argument == "--cache") {
+				cache = true;
+			} else if (argument == "--auto") {
+				auto_prove = true;
+			} else if (argument == "-j") {
+				if (i + 1 == argc) {
+					throw std::invalid_argument(usage);
+				}
+				
+				threads = parse_threads(argv[++i], usage);
+			} else if (argument == "--verbose") {
+				verbose = true;
+			} else if (formula_path.empty()) {
+				formula_path = argument;
+			} else {
+				throw std::invalid_argument(usage);
+			}
 		}
 		
-		formula = parse_formula(argv[1]);
+		// The cache is keyed by the problem file alone, which does not cover
+		// the files a TPTP problem includes.
+		if (formula_path.empty() or (verbose and script_path.empty()) or (cache and tptp) or (auto_prove and !script_path.empty()) or (threads != 1 and !script_path.empty())) {
+			throw std::invalid_argument(usage);
+		}
+		
+		if (tptp) {
+			formula = read_tptp_goal(formula_path, conjecture_name);
+		} else if (conjecture_name.empty()) {
+			auto load = [&]() {
+				return parse_formula(formula_path);
+			};
+			
+			formula = cache ? load_cached_formula(formula_path, "formula", load) : load();
+		} else {
+			auto load = [&]() {
+				return read_problem_goal(formula_path, conjecture_name);
+			};
+			
+			formula = cache ? load_cached_formula(formula_path, "conjecture " + conjecture_name, load) : load();
+		}
+		
+		if (auto_prove) {
+			SearchOptions options;
+			options.threads = threads;
+			
+			SearchResult result = search_proof(ProofStateManager(formula), options);
+			
+			if (!result.proved) {
+				std::cerr << "No proof found." << std::endl;
+				return 2;
+			}
+			
+			for (const auto& step : result.proof) {
+				std::cout << step.command << std::endl;
+			}
+			
+			std::cout << "done" << std::endl;
+			return 0;
+		}
+		
+		if (script_path.empty()) {
+			Prover::start_interactive_proof(formula, threads);
+			return 0;
+		}
+		
+		std::ifstream script(script_path);
+		
+		if (!script) {
+			throw std::runtime_error("Error opening file: " + script_path);
+		}
+		
+		ScriptResult result = Prover::check_proof_script(formula, script, verbose);
+		
+		if (!result.proved) {
+			std::cerr << "Proof not closed: " << result.error << std::endl;
+		}
 		
-		Prover::start_interactive_proof(formula);
+		return result.proved ? 0 : 2;
 	} catch (const std::exception& e) {
 		std::cerr << "Error:" << std::endl;
 		std::cerr << e.what() << std::endl;
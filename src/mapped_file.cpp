@@ -0,0 +1,51 @@
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.hpp"
+
+MappedFile::MappedFile(const std::string& filename) {
+	int fd = open(filename.c_str(), O_RDONLY);
+	
+	if (fd < 0) {
+		throw std::runtime_error("Error opening file: " + filename);
+	}
+	
+	struct stat file_stat;
+	
+	if (fstat(fd, &file_stat) != 0) {
+		close(fd);
+		throw std::runtime_error("Error opening file: " + filename);
+	}
+	
+	_size = file_stat.st_size;
+	
+	// mmap rejects empty mappings, and an empty file needs none.
+	if (_size > 0) {
+		_data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	
+	close(fd);
+	
+	if (_data == MAP_FAILED) {
+		throw std::runtime_error("Error reading file: " + filename);
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (_data != nullptr) {
+		munmap(_data, _size);
+	}
+}
+
+std::string_view MappedFile::contents() const {
+	if (_data == nullptr) {
+		return std::string_view();
+	}
+	
+	return std::string_view(static_cast<const char*>(_data), _size);
+}
+
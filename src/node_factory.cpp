@@ -0,0 +1,199 @@
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <mutex>
+
+#include "node_factory.hpp"
+#include "node_pool.hpp"
+#include "atom.hpp"
+#include "connective.hpp"
+#include "quantifier.hpp"
+
+namespace {
+
+struct NodeKey {
+	unsigned kind;
+	// For a quantifier, the display name of its variable, so alpha-variants
+	// are kept as separate nodes.
+	unsigned symbol;
+	std::vector<const void*> children;
+	
+	bool operator==(const NodeKey& other) const {
+		return kind == other.kind and symbol == other.symbol and children == other.children;
+	}
+};
+
+struct NodeKeyHash {
+	size_t operator()(const NodeKey& key) const {
+		size_t h = key.symbol ^ (key.kind * 0x9e3779b97f4a7c15ULL);
+		
+		for (const void* child : key.children) {
+			h ^= std::hash<const void*>()(child) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+		}
+		
+		return h;
+	}
+};
+
+// The table is split into independently locked shards, so threads interning
+// unrelated nodes rarely wait for each other.
+template <typename Base>
+class NodeTable {
+	public:
+		template <typename Node, typename... Args>
+		std::shared_ptr<Node> intern(NodeKey&& key, Args&&... args) {
+			size_t hash = NodeKeyHash()(key);
+			Shard& shard = _shards[(hash >> 7) % shard_count];
+			
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			
+			auto it = shard.nodes.find(key);
+			
+			if (it != shard.nodes.end()) {
+				if (auto existing = it->second.lock()) {
+					return std::static_pointer_cast<Node>(existing);
+				}
+			}
+			
+#ifdef NO_NODE_POOL
+			auto node = std::make_shared<Node>(std::forward<Args>(args)...);
+#else
+			auto node = std::allocate_shared<Node>(PoolAllocator<Node>(), std::forward<Args>(args)...);
+#endif
+			
+			if (it != shard.nodes.end()) {
+				it->second = node;
+			} else {
+				shard.nodes.emplace(std::move(key), node);
+				sweep(shard);
+			}
+			
+			return node;
+		}
+	private:
+		struct Shard {
+			std::mutex mutex;
+			std::unordered_map<NodeKey, std::weak_ptr<Base>, NodeKeyHash> nodes;
+			size_t sweep_threshold = 1024;
+		};
+		
+		static void sweep(Shard& shard) {
+			if (shard.nodes.size() < shard.sweep_threshold) {
+				return;
+			}
+			
+			for (auto it = shard.nodes.begin(); it != shard.nodes.end();) {
+				if (it->second.expired()) {
+					it = shard.nodes.erase(it);
+				} else {
+					++it;
+				}
+			}
+			
+			shard.sweep_threshold = std::max(shard.sweep_threshold, 2 * shard.nodes.size());
+		}
+	private:
+		static constexpr size_t shard_count = 16;
+		
+		Shard _shards[shard_count];
+};
+
+NodeTable<Term>& term_table() {
+	static NodeTable<Term> table;
+	return table;
+}
+
+NodeTable<Formula>& formula_table() {
+	static NodeTable<Formula> table;
+	return table;
+}
+
+std::vector<const void*> children_of(const std::vector<std::shared_ptr<Term>>& terms) {
+	std::vector<const void*> children;
+	children.reserve(terms.size());
+	
+	for (const auto& t : terms) {
+		children.push_back(t.get());
+	}
+	
+	return children;
+}
+
+unsigned kind_of(TermType type) {
+	return static_cast<unsigned>(type);
+}
+
+unsigned kind_of(FormulaType type) {
+	return static_cast<unsigned>(type);
+}
+
+}
+
+std::shared_ptr<Variable> NodeFactory::make_variable(const Symbol& name) {
+	return term_table().intern<Variable>({kind_of(TermType::Variable), name.id(), {}}, name);
+}
+
+std::shared_ptr<BoundVariable> NodeFactory::make_bound_variable(unsigned index) {
+	return term_table().intern<BoundVariable>({kind_of(TermType::BoundVariable), index, {}}, index);
+}
+
+std::shared_ptr<Constant> NodeFactory::make_constant(const Symbol& name) {
+	return term_table().intern<Constant>({kind_of(TermType::Constant), name.id(), {}}, name);
+}
+
+std::shared_ptr<ComplexTerm> NodeFactory::make_complex_term(const Symbol& f, const std::vector<std::shared_ptr<Term>>& terms) {
+	return term_table().intern<ComplexTerm>({kind_of(TermType::ComplexTerm), f.id(), children_of(terms)}, f, terms);
+}
+
+std::shared_ptr<True> NodeFactory::make_true() {
+	return formula_table().intern<True>({kind_of(FormulaType::True), 0, {}});
+}
+
+std::shared_ptr<False> NodeFactory::make_false() {
+	return formula_table().intern<False>({kind_of(FormulaType::False), 0, {}});
+}
+
+std::shared_ptr<SimpleAtom> NodeFactory::make_simple_atom(const Symbol& p) {
+	return formula_table().intern<SimpleAtom>({kind_of(FormulaType::SimpleAtom), p.id(), {}}, p);
+}
+
+std::shared_ptr<ComplexAtom> NodeFactory::make_complex_atom(const Symbol& p, const std::vector<std::shared_ptr<Term>>& terms) {
+	return formula_table().intern<ComplexAtom>({kind_of(FormulaType::ComplexAtom), p.id(), children_of(terms)}, p, terms);
+}
+
+std::shared_ptr<Negation> NodeFactory::make_negation(const std::shared_ptr<Formula>& sub) {
+	return formula_table().intern<Negation>({kind_of(FormulaType::Negation), 0, {sub.get()}}, sub);
+}
+
+std::shared_ptr<Conjunction> NodeFactory::make_conjunction(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r) {
+	return formula_table().intern<Conjunction>({kind_of(FormulaType::Conjunction), 0, {l.get(), r.get()}}, l, r);
+}
+
+std::shared_ptr<Disjunction> NodeFactory::make_disjunction(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r) {
+	return formula_table().intern<Disjunction>({kind_of(FormulaType::Disjunction), 0, {l.get(), r.get()}}, l, r);
+}
+
+std::shared_ptr<Implication> NodeFactory::make_implication(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r) {
+	return formula_table().intern<Implication>({kind_of(FormulaType::Implication), 0, {l.get(), r.get()}}, l, r);
+}
+
+std::shared_ptr<Equivalence> NodeFactory::make_equivalence(const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r) {
+	return formula_table().intern<Equivalence>({kind_of(FormulaType::Equivalence), 0, {l.get(), r.get()}}, l, r);
+}
+
+std::shared_ptr<ForAll> NodeFactory::make_for_all(const Symbol& var, const std::shared_ptr<Formula>& sub) {
+	return make_for_all_scope(var, sub->abstract_var(var, 0));
+}
+
+std::shared_ptr<Exists> NodeFactory::make_exists(const Symbol& var, const std::shared_ptr<Formula>& sub) {
+	return make_exists_scope(var, sub->abstract_var(var, 0));
+}
+
+std::shared_ptr<ForAll> NodeFactory::make_for_all_scope(const Symbol& var, const std::shared_ptr<Formula>& scope) {
+	return formula_table().intern<ForAll>({kind_of(FormulaType::ForAll), var.id(), {scope.get()}}, var, scope);
+}
+
+std::shared_ptr<Exists> NodeFactory::make_exists_scope(const Symbol& var, const std::shared_ptr<Formula>& scope) {
+	return formula_table().intern<Exists>({kind_of(FormulaType::Exists), var.id(), {scope.get()}}, var, scope);
+}
+
@@ -0,0 +1,191 @@
+#include <fstream>
+#include <cctype>
+#include <algorithm>
+
+#include "problem_reader.hpp"
+#include "fast_parser.hpp"
+#include "connective.hpp"
+#include "node_factory.hpp"
+
+std::shared_ptr<Formula> ProblemEntry::parse_formula() const {
+	try {
+		return fast_parse_formula(formula_text);
+	} catch (const std::runtime_error& e) {
+		throw std::runtime_error("In entry " + name + " on line " + std::to_string(line) + ": " + e.what());
+	}
+}
+
+bool ProblemEntry::is_premise() const {
+	return is_premise_role(role);
+}
+
+bool is_premise_role(const std::string& role) {
+	static const std::vector<std::string> premise_roles = {"axiom", "hypothesis", "definition", "assumption", "lemma", "theorem", "corollary"};
+	
+	return std::find(premise_roles.begin(), premise_roles.end(), role) != premise_roles.end();
+}
+
+bool ProblemReader::next(ProblemEntry& entry) {
+	skip_whitespace();
+	
+	if (_input.peek() == EOF) {
+		return false;
+	}
+	
+	entry.position = _input.tellg();
+	entry.line = _line;
+	
+	if (read_word() != "fof") {
+		throw error("expected fof(name, role, formula).");
+	}
+	
+	expect('(');
+	entry.name = read_word();
+	expect(',');
+	entry.role = read_word();
+	expect(',');
+	
+	// The formula syntax has no quoted text, so the entry ends at the
+	// parenthesis matching the one after fof.
+	entry.formula_text.clear();
+	unsigned depth = 0;
+	
+	while (true) {
+		int c = get();
+		
+		if (c == EOF) {
+			throw error("unterminated entry " + entry.name);
+		}
+		
+		if (c == '%') {
+			skip_line();
+			entry.formula_text += '\n';
+			continue;
+		}
+		
+		if (c == ')') {
+			if (depth == 0) {
+				break;
+			}
+			
+			depth--;
+		} else if (c == '(') {
+			depth++;
+		}
+		
+		entry.formula_text += static_cast<char>(c);
+	}
+	
+	expect('.');
+	
+	return true;
+}
+
+void ProblemReader::seek(const ProblemEntry& entry) {
+	_input.clear();
+	_input.seekg(entry.position);
+	_line = entry.line;
+}
+
+int ProblemReader::get() {
+	int c = _input.get();
+	
+	if (c == '\n') {
+		_line++;
+	}
+	
+	return c;
+}
+
+void ProblemReader::skip_line() {
+	int c;
+	
+	do {
+		c = get();
+	} while (c != '\n' and c != EOF);
+}
+
+void ProblemReader::skip_whitespace() {
+	while (true) {
+		int c = _input.peek();
+		
+		if (c == '%') {
+			skip_line();
+		} else if (c != EOF and std::isspace(c)) {
+			get();
+		} else {
+			return;
+		}
+	}
+}
+
+std::string ProblemReader::read_word() {
+	skip_whitespace();
+	
+	std::string word;
+	
+	while (_input.peek() != EOF and (std::isalnum(_input.peek()) or _input.peek() == '_')) {
+		word += static_cast<char>(get());
+	}
+	
+	if (word.empty()) {
+		throw error("expected a name");
+	}
+	
+	return word;
+}
+
+void ProblemReader::expect(char c) {
+	skip_whitespace();
+	
+	if (get() != c) {
+		throw error(std::string("expected '") + c + "'");
+	}
+}
+
+std::runtime_error ProblemReader::error(const std::string& message) const {
+	return std::runtime_error("Line " + std::to_string(_line) + ": " + message);
+}
+
+std::shared_ptr<Formula> make_problem_goal(const std::vector<std::shared_ptr<Formula>>& premises, const std::shared_ptr<Formula>& conjecture) {
+	std::shared_ptr<Formula> goal = conjecture;
+	
+	for (auto it = premises.rbegin(); it != premises.rend(); ++it) {
+		goal = NodeFactory::make_implication(*it, goal);
+	}
+	
+	return goal;
+}
+
+std::shared_ptr<Formula> read_problem_goal(const std::string& filename, const std::string& conjecture_name) {
+	std::ifstream file(filename);
+	
+	if (!file) {
+		throw std::runtime_error("Error opening file: " + filename);
+	}
+	
+	ProblemReader reader(file);
+	ProblemEntry entry;
+	
+	std::vector<std::shared_ptr<Formula>> premises;
+	std::shared_ptr<Formula> conjecture;
+	
+	try {
+		while (reader.next(entry)) {
+			if (entry.name == conjecture_name) {
+				conjecture = entry.parse_formula();
+			} else if (entry.is_premise()) {
+				premises.push_back(entry.parse_formula());
+			}
+		}
+	} catch (const std::runtime_error& e) {
+		throw std::runtime_error(filename + ": " + e.what());
+	}
+	
+	if (!conjecture) {
+		throw std::runtime_error(filename + ": no entry named " + conjecture_name);
+	}
+	
+	return make_problem_goal(premises, conjecture);
+}
+
@@ -0,0 +1,811 @@
+#include <unordered_set>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <optional>
+
+#include "proof_search.hpp"
+#include "atom.hpp"
+#include "connective.hpp"
+#include "quantifier.hpp"
+#include "node_factory.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+// Target rules first, so the goal is broken up before its assumptions are.
+const Rule invertible_rules[] = {
+	Rule::ImpI,
+	Rule::NotI,
+	Rule::AllI,
+	Rule::ConjI,
+	Rule::IffI,
+	Rule::ConjE,
+	Rule::ExE,
+	Rule::IffE,
+	Rule::DisjE
+};
+
+// The rule applications that solve the goals, in the order they are applied.
+// Positions of assumptions refer to the goal each one is applied to.
+using Script = std::vector<RuleApplication>;
+
+// Remembers, by canonical goal hash, a proof of the goal or the greatest depth
+// it is known to fail at. A goal replaces whatever shared its slot before.
+// The table is split into segments with their own locks, which start small
+// and grow up to the limit, so short searches do not pay for a large table.
+class TranspositionTable {
+	public:
+		struct Entry {
+			SequentHash key;
+			bool used = false;
+			std::optional<unsigned> failed_depth;
+			std::shared_ptr<const Script> proof;
+		};
+		
+		TranspositionTable(size_t entries)
+			:_segment_limit(entries == 0 ? 0 : std::max<size_t>(entries / segment_count, 1))
+		{}
+		
+		std::optional<Entry> find(const SequentHash& key) {
+			if (_segment_limit == 0) {
+				return std::nullopt;
+			}
+			
+			Segment& segment = segment_for(key);
+			std::lock_guard<std::mutex> lock(segment.mutex);
+			
+			if (segment.entries.empty()) {
+				return std::nullopt;
+			}
+			
+			const Entry& entry = slot(segment, key);
+			
+			if (!entry.used or entry.key != key) {
+				return std::nullopt;
+			}
+			
+			return entry;
+		}
+		
+		void store_proof(const SequentHash& key, const Script& proof) {
+			if (_segment_limit == 0) {
+				return;
+			}
+			
+			Segment& segment = segment_for(key);
+			std::lock_guard<std::mutex> lock(segment.mutex);
+			
+			claim(segment, key).proof = std::make_shared<const Script>(proof);
+		}
+		
+		void store_failure(const SequentHash& key, unsigned depth) {
+			if (_segment_limit == 0) {
+				return;
+			}
+			
+			Segment& segment = segment_for(key);
+			std::lock_guard<std::mutex> lock(segment.mutex);
+			Entry& entry = claim(segment, key);
+			
+			if (!entry.failed_depth or *entry.failed_depth < depth) {
+				entry.failed_depth = depth;
+			}
+		}
+	private:
+		struct Segment {
+			std::mutex mutex;
+			std::vector<Entry> entries;
+			size_t used = 0;
+		};
+		
+		Segment& segment_for(const SequentHash& key) {
+			return _segments[key.high % segment_count];
+		}
+		
+		static Entry& slot(Segment& segment, const SequentHash& key) {
+			return segment.entries[key.low % segment.entries.size()];
+		}
+		
+		Entry& claim(Segment& segment, const SequentHash& key) {
+			if (segment.entries.empty()) {
+				segment.entries.resize(std::min<size_t>(initial_segment_size, _segment_limit));
+			}
+			
+			if (!slot(segment, key).used and 4 * (segment.used + 1) > 3 * segment.entries.size() and segment.entries.size() < _segment_limit) {
+				grow(segment);
+			}
+			
+			Entry& entry = slot(segment, key);
+			
+			if (!entry.used) {
+				segment.used++;
+			}
+			
+			if (!entry.used or entry.key != key) {
+				entry = Entry();
+				entry.key = key;
+				entry.used = true;
+			}
+			
+			return entry;
+		}
+		
+		void grow(Segment& segment) {
+			std::vector<Entry> entries(std::min(2 * segment.entries.size(), _segment_limit));
+			
+			std::swap(entries, segment.entries);
+			segment.used = 0;
+			
+			for (auto& entry : entries) {
+				if (!entry.used) {
+					continue;
+				}
+				
+				Entry& moved = slot(segment, entry.key);
+				
+				if (!moved.used) {
+					segment.used++;
+				}
+				
+				moved = std::move(entry);
+			}
+		}
+	private:
+		static constexpr size_t segment_count = 64;
+		static constexpr size_t initial_segment_size = 16;
+		
+		size_t _segment_limit;
+		Segment _segments[segment_count];
+};
+
+struct StepLimitReached {};
+struct SearchCancelled {};
+
+// Shared by every thread working on one search.
+struct SearchShared {
+	const SearchOptions& options;
+	std::atomic<unsigned long> steps{0};
+	// Set when the step limit is reached or a branch throws, to end the
+	// whole search.
+	std::atomic<bool> stopped{false};
+	std::mutex mutex;
+	std::exception_ptr error;
+	TranspositionTable table;
+	
+	SearchShared(const SearchOptions& o)
+		:options(o), table(o.table_entries)
+	{}
+};
+
+// Set when the result of a branch is no longer needed: a sibling alternative
+// has succeeded, or a sibling goal has failed. Cancelling a branch cancels
+// everything started from it.
+struct CancelFlag {
+	std::atomic<bool> cancelled{false};
+	std::shared_ptr<CancelFlag> parent;
+	
+	CancelFlag(const std::shared_ptr<CancelFlag>& p)
+		:parent(p)
+	{}
+	
+	bool is_set() const {
+		for (const CancelFlag* flag = this; flag != nullptr; flag = flag->parent.get()) {
+			if (flag->cancelled) {
+				return true;
+			}
+		}
+		
+		return false;
+	}
+};
+
+// A non-invertible step: the state after it and the step that leads there.
+struct Alternative {
+	ProofStateManager state;
+	RuleApplication application;
+};
+
+// The command applying a rule to the goal. Without a position, an elimination
+// rule takes the first assumption of its kind, so the position is only spelled
+// out for the others.
+std::string command_for(const Goal& goal, const RuleApplication& application) {
+	std::string name;
+	std::optional<FormulaType> eliminated;
+	
+	switch (application.rule) {
+		case Rule::Assumption:
+			return "apply assumption";
+		case Rule::NotI:
+			name = "notI";
+			break;
+		case Rule::ConjI:
+			name = "conjI";
+			break;
+		case Rule::DisjI1:
+			name = "disjI1";
+			break;
+		case Rule::DisjI2:
+			name = "disjI2";
+			break;
+		case Rule::ImpI:
+			name = "impI";
+			break;
+		case Rule::IffI:
+			name = "iffI";
+			break;
+		case Rule::AllI:
+			name = "allI";
+			break;
+		case Rule::ExI:
+			name = "exI";
+			break;
+		case Rule::Ccontr:
+			name = "ccontr";
+			break;
+		case Rule::Classical:
+			name = "classical";
+			break;
+		case Rule::NotE:
+			name = "notE";
+			eliminated = FormulaType::Negation;
+			break;
+		case Rule::ConjE:
+			name = "conjE";
+			eliminated = FormulaType::Conjunction;
+			break;
+		case Rule::DisjE:
+			name = "disjE";
+			eliminated = FormulaType::Disjunction;
+			break;
+		case Rule::ImpE:
+			name = "impE";
+			eliminated = FormulaType::Implication;
+			break;
+		case Rule::IffE:
+			name = "iffE";
+			eliminated = FormulaType::Equivalence;
+			break;
+		case Rule::AllE:
+			name = "allE";
+			eliminated = FormulaType::ForAll;
+			break;
+		case Rule::ExE:
+			name = "exE";
+			eliminated = FormulaType::Exists;
+			break;
+	}
+	
+	std::string command = (eliminated ? "apply erule " : "apply rule ") + name;
+	
+	if (application.assumption) {
+		auto assumptions = goal.get_assumptions();
+		auto first = std::find_if(assumptions.begin(), assumptions.end(), [&eliminated](const auto& assumption) {
+			return assumption->type() == eliminated;
+		});
+		
+		if (static_cast<unsigned>(first - assumptions.begin()) != *application.assumption) {
+			command += "[" + std::to_string(*application.assumption + 1) + "]";
+		}
+	}
+	
+	for (const auto& term : application.terms) {
+		command += " " + term->to_string();
+	}
+	
+	return command;
+}
+
+void collect_terms(const std::shared_ptr<Term>& term, std::vector<std::shared_ptr<Term>>& terms, std::unordered_set<const Term*>& seen) {
+	if (term->loose_depth() > 0 or !seen.insert(term.get()).second) {
+		return;
+	}
+	
+	terms.push_back(term);
+	
+	if (term->type() == TermType::ComplexTerm) {
+		for (const auto& t : std::static_pointer_cast<ComplexTerm>(term)->get_subterms()) {
+			collect_terms(t, terms, seen);
+		}
+	}
+}
+
+void collect_terms(const std::shared_ptr<Formula>& formula, std::vector<std::shared_ptr<Term>>& terms, std::unordered_set<const Term*>& seen) {
+	switch (formula->type()) {
+		case FormulaType::ComplexAtom:
+			for (const auto& t : std::static_pointer_cast<ComplexAtom>(formula)->get_terms()) {
+				collect_terms(t, terms, seen);
+			}
+			break;
+		case FormulaType::Negation:
+			collect_terms(std::static_pointer_cast<Negation>(formula)->get_subformula(), terms, seen);
+			break;
+		case FormulaType::Conjunction:
+		case FormulaType::Disjunction:
+		case FormulaType::Implication:
+		case FormulaType::Equivalence: {
+			auto connective = std::static_pointer_cast<BinaryConnective>(formula);
+			collect_terms(connective->get_left_subformula(), terms, seen);
+			collect_terms(connective->get_right_subformula(), terms, seen);
+			break;
+		}
+		case FormulaType::ForAll:
+		case FormulaType::Exists:
+			collect_terms(std::static_pointer_cast<Quantifier>(formula)->get_subformula(), terms, seen);
+			break;
+		default:
+			break;
+	}
+}
+
+// The closed terms occurring in the goal, smallest first. A goal without any
+// still needs a term to instantiate with, and any variable will do.
+std::vector<std::shared_ptr<Term>> instantiation_terms(const Goal& goal) {
+	std::vector<std::shared_ptr<Term>> terms;
+	std::unordered_set<const Term*> seen;
+	
+	collect_terms(goal.get_target(), terms, seen);
+	
+	for (const auto& assumption : goal.get_assumptions()) {
+		collect_terms(assumption, terms, seen);
+	}
+	
+	if (terms.empty()) {
+		terms.push_back(NodeFactory::make_variable(Symbol("X")));
+	}
+	
+	std::stable_sort(terms.begin(), terms.end(), [](const auto& t1, const auto& t2) {
+		return t1->size() < t2->size();
+	});
+	
+	return terms;
+}
+
+class ProofSearch {
+	public:
+		ProofSearch(SearchShared& shared, const std::shared_ptr<CancelFlag>& cancel = nullptr)
+			:_shared(shared), _cancel(cancel)
+		{}
+		
+		// Solves goals from the front until only `remaining` are left. On
+		// failure the state is in an unspecified intermediate form.
+		bool prove_goals(ProofStateManager& state, size_t remaining, unsigned depth, Script& script) {
+			while (state.goals_left() > remaining) {
+				if (!prove_current_goal(state, depth, script)) {
+					return false;
+				}
+			}
+			
+			return true;
+		}
+		
+		// Leaves the state and the script unchanged on failure.
+		bool prove_current_goal(ProofStateManager& state, unsigned depth, Script& script) {
+			size_t remaining = state.goals_left() - 1;
+			size_t script_size = script.size();
+			
+			if (auto next = successor(state, {Rule::Assumption})) {
+				state = *next;
+				script.push_back({Rule::Assumption});
+				return true;
+			}
+			
+			SequentHash key = state.current_goal().canonical_hash();
+			
+			if (auto entry = _shared.table.find(key)) {
+				if (entry->proof and replay(state, remaining, *entry->proof, script)) {
+					return true;
+				}
+				
+				if (entry->failed_depth and *entry->failed_depth >= depth) {
+					return false;
+				}
+			}
+			
+			if (!search_current_goal(state, depth, script)) {
+				_shared.table.store_failure(key, depth);
+				return false;
+			}
+			
+			_shared.table.store_proof(key, Script(script.begin() + script_size, script.end()));
+			return true;
+		}
+		
+		std::vector<Alternative> alternatives(const ProofStateManager& state) {
+			std::vector<Alternative> result;
+			
+			const Goal& goal = state.current_goal();
+			auto target = goal.get_target();
+			auto assumptions = goal.get_assumptions();
+			auto terms = instantiation_terms(goal);
+			
+			add(result, state, {Rule::DisjI1});
+			
+			add(result, state, {Rule::DisjI2});
+			
+			if (target->type() == FormulaType::Exists) {
+				for (const auto& term : terms) {
+					add(result, state, {Rule::ExI, std::nullopt, {term}});
+				}
+			}
+			
+			for (unsigned i = 0; i < assumptions.size(); i++) {
+				if (assumptions[i]->type() == FormulaType::Implication) {
+					add(result, state, {Rule::ImpE, i});
+				}
+			}
+			
+			for (unsigned i = 0; i < assumptions.size(); i++) {
+				if (assumptions[i]->type() != FormulaType::ForAll) {
+					continue;
+				}
+				
+				for (const auto& term : terms) {
+					add(result, state, {Rule::AllE, i, {term}});
+				}
+			}
+			
+			// notE discards the target, which only costs nothing when it is ⊥.
+			if (target->type() == FormulaType::False) {
+				for (unsigned i = 0; i < assumptions.size(); i++) {
+					if (assumptions[i]->type() == FormulaType::Negation) {
+						add(result, state, {Rule::NotE, i});
+					}
+				}
+			}
+			
+			// notE uses up the negation it eliminates, so a negated target
+			// may be needed again after ccontr has been applied once.
+			auto negated_target = NodeFactory::make_negation(target);
+			
+			if (target->type() != FormulaType::False and std::find(assumptions.begin(), assumptions.end(), negated_target) == assumptions.end()) {
+				add(result, state, {Rule::Ccontr});
+				
+				add(result, state, {Rule::Classical});
+			}
+			
+			return result;
+		}
+		
+		std::optional<ProofStateManager> successor(const ProofStateManager& state, const RuleApplication& application) {
+			count_step();
+			return state.successor(application);
+		}
+	private:
+		// prove_current_goal past the assumption rule and the table.
+		bool search_current_goal(ProofStateManager& state, unsigned depth, Script& script) {
+			size_t remaining = state.goals_left() - 1;
+			size_t script_size = script.size();
+			
+			for (const auto& rule : invertible_rules) {
+				auto next = successor(state, {rule});
+				
+				if (!next) {
+					continue;
+				}
+				
+				script.push_back({rule});
+				
+				if (prove_goals(*next, remaining, depth, script)) {
+					state = *next;
+					return true;
+				}
+				
+				script.resize(script_size);
+				return false;
+			}
+			
+			if (depth == 0) {
+				return false;
+			}
+			
+			for (auto& alternative : alternatives(state)) {
+				script.push_back(alternative.application);
+				
+				if (prove_goals(alternative.state, remaining, depth - 1, script)) {
+					state = alternative.state;
+					return true;
+				}
+				
+				script.resize(script_size);
+			}
+			
+			return false;
+		}
+		
+		// A proof recorded for an equivalent goal fits this one too unless the
+		// two differ in the order of their assumptions or the names of their
+		// meta-variables, which the replay finds out.
+		bool replay(ProofStateManager& state, size_t remaining, const Script& proof, Script& script) {
+			ProofStateManager next = state;
+			
+			for (const auto& application : proof) {
+				if (next.goals_left() <= remaining) {
+					return false;
+				}
+				
+				auto after = successor(next, application);
+				
+				if (!after) {
+					return false;
+				}
+				
+				next = std::move(*after);
+			}
+			
+			if (next.goals_left() != remaining) {
+				return false;
+			}
+			
+			state = next;
+			script.insert(script.end(), proof.begin(), proof.end());
+			return true;
+		}
+		
+		void add(std::vector<Alternative>& result, const ProofStateManager& state, const RuleApplication& application) {
+			if (auto next = successor(state, application)) {
+				result.push_back({std::move(*next), application});
+			}
+		}
+		
+		void count_step() {
+			if (_shared.stopped or (_cancel and _cancel->is_set())) {
+				throw SearchCancelled();
+			}
+			
+			if (++_shared.steps > _shared.options.max_steps) {
+				throw StepLimitReached();
+			}
+		}
+	private:
+		SearchShared& _shared;
+		std::shared_ptr<CancelFlag> _cancel;
+};
+
+// Runs the first levels of the search tree as pool tasks: the goals an
+// invertible rule or an alternative splits into are proved side by side, and
+// so are the alternatives at a choice point. Below parallel_levels choice
+// points the sequential search takes over. Works on states holding one goal.
+class ParallelSearch {
+	public:
+		ParallelSearch(SearchShared& shared, WorkStealingPool& pool)
+			:_shared(shared), _pool(pool)
+		{}
+		
+		bool prove_root(const ProofStateManager& state, unsigned depth, Script& script) {
+			return run_branch([&] {
+				return prove(state, depth, 0, nullptr, script);
+			});
+		}
+	private:
+		bool prove(const ProofStateManager& state, unsigned depth, unsigned level, const std::shared_ptr<CancelFlag>& cancel, Script& script) {
+			ProofSearch search(_shared, cancel);
+			
+			if (level >= parallel_levels) {
+				ProofStateManager next = state;
+				return search.prove_goals(next, 0, depth, script);
+			}
+			
+			if (search.successor(state, {Rule::Assumption})) {
+				script.push_back({Rule::Assumption});
+				return true;
+			}
+			
+			for (const auto& rule : invertible_rules) {
+				if (auto next = search.successor(state, {rule})) {
+					script.push_back({rule});
+					return prove_all(next->get_goals(), depth, level, cancel, script);
+				}
+			}
+			
+			if (depth == 0) {
+				return false;
+			}
+			
+			return prove_any(search.alternatives(state), depth - 1, level + 1, cancel, script);
+		}
+		
+		// Catches whatever ends a branch early, so the tasks it waits for are
+		// always waited for.
+		template <typename Branch>
+		bool run_branch(const Branch& branch) {
+			try {
+				return branch();
+			} catch (const SearchCancelled&) {
+			} catch (const StepLimitReached&) {
+				_shared.stopped = true;
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(_shared.mutex);
+				
+				if (!_shared.error) {
+					_shared.error = std::current_exception();
+				}
+				
+				_shared.stopped = true;
+			}
+			
+			return false;
+		}
+		
+		bool prove_all(const std::vector<Goal>& goals, unsigned depth, unsigned level, const std::shared_ptr<CancelFlag>& cancel, Script& script) {
+			if (goals.size() == 1) {
+				return prove(ProofStateManager(goals[0]), depth, level, cancel, script);
+			}
+			
+			auto group = std::make_shared<CancelFlag>(cancel);
+			std::vector<Script> scripts(goals.size());
+			std::unique_ptr<bool[]> proved(new bool[goals.size()]());
+			std::atomic<size_t> pending(goals.size());
+			
+			auto prove_goal = [&, depth, level](size_t i) {
+				proved[i] = run_branch([&] {
+					return prove(ProofStateManager(goals[i]), depth, level, group, scripts[i]);
+				});
+				
+				if (!proved[i]) {
+					group->cancelled = true;
+				}
+				
+				pending--;
+			};
+			
+			for (size_t i = 1; i < goals.size(); i++) {
+				_pool.submit([&prove_goal, i] { prove_goal(i); });
+			}
+			
+			prove_goal(0);
+			
+			_pool.help_until([&pending] { return pending == 0; });
+			
+			for (size_t i = 0; i < goals.size(); i++) {
+				if (!proved[i]) {
+					return false;
+				}
+			}
+			
+			for (const auto& goal_script : scripts) {
+				script.insert(script.end(), goal_script.begin(), goal_script.end());
+			}
+			
+			return true;
+		}
+		
+		// Takes the first alternative to succeed.
+		bool prove_any(const std::vector<Alternative>& alternatives, unsigned depth, unsigned level, const std::shared_ptr<CancelFlag>& cancel, Script& script) {
+			if (alternatives.empty()) {
+				return false;
+			}
+			
+			auto group = std::make_shared<CancelFlag>(cancel);
+			std::mutex mutex;
+			bool found = false;
+			Script found_script;
+			std::atomic<size_t> pending(alternatives.size());
+			
+			auto try_alternative = [&, depth, level](size_t i) {
+				Script alternative_script = {alternatives[i].application};
+				
+				bool proved = !group->is_set() and run_branch([&] {
+					return prove_all(alternatives[i].state.get_goals(), depth, level, group, alternative_script);
+				});
+				
+				if (proved) {
+					std::lock_guard<std::mutex> lock(mutex);
+					
+					if (!found) {
+						found = true;
+						found_script = std::move(alternative_script);
+					}
+					
+					group->cancelled = true;
+				}
+				
+				pending--;
+			};
+			
+			for (size_t i = 1; i < alternatives.size(); i++) {
+				_pool.submit([&try_alternative, i] { try_alternative(i); });
+			}
+			
+			try_alternative(0);
+			
+			_pool.help_until([&pending] { return pending == 0; });
+			
+			if (found) {
+				script.insert(script.end(), found_script.begin(), found_script.end());
+			}
+			
+			return found;
+		}
+	private:
+		static constexpr unsigned parallel_levels = 3;
+		
+		SearchShared& _shared;
+		WorkStealingPool& _pool;
+};
+
+// Iterative deepening, one goal at a time.
+template <typename ProveGoal>
+SearchResult run_search(const ProofStateManager& initial_state, SearchShared& shared, const ProveGoal& prove_goal) {
+	Script script;
+	
+	for (const auto& goal : initial_state.get_goals()) {
+		ProofStateManager state(goal);
+		bool proved = false;
+		
+		for (unsigned depth = 0; depth <= shared.options.max_depth and !proved and !shared.stopped; depth++) {
+			size_t script_size = script.size();
+			
+			proved = prove_goal(state, depth, script);
+			
+			if (!proved) {
+				script.resize(script_size);
+			}
+		}
+		
+		if (!proved) {
+			return {false, {}, shared.steps};
+		}
+	}
+	
+	// Replaying the proof from the searched state gives every step the goal
+	// its command is written for.
+	std::vector<ProofStep> proof;
+	ProofStateManager state = initial_state;
+	
+	for (const auto& application : script) {
+		auto next = state.successor(application);
+		
+		if (!next) {
+			return {false, {}, shared.steps};
+		}
+		
+		proof.push_back({application, command_for(state.current_goal(), application)});
+		state = std::move(*next);
+	}
+	
+	if (!state.goals_solved()) {
+		return {false, {}, shared.steps};
+	}
+	
+	return {true, proof, shared.steps};
+}
+
+}
+
+SearchResult search_proof(const ProofStateManager& initial_state, const SearchOptions& options) {
+	SearchShared shared(options);
+	
+	if (options.threads <= 1) {
+		ProofSearch search(shared);
+		
+		try {
+			return run_search(initial_state, shared, [&search](const ProofStateManager& state, unsigned depth, Script& script) {
+				ProofStateManager next = state;
+				return search.prove_goals(next, 0, depth, script);
+			});
+		} catch (const StepLimitReached&) {
+			return {false, {}, shared.steps};
+		}
+	}
+	
+	// The calling thread works on the search too.
+	WorkStealingPool pool(options.threads - 1);
+	ParallelSearch search(shared, pool);
+	
+	SearchResult result = run_search(initial_state, shared, [&search](const ProofStateManager& state, unsigned depth, Script& script) {
+		return search.prove_root(state, depth, script);
+	});
+	
+	if (shared.error) {
+		std::rethrow_exception(shared.error);
+	}
+	
+	if (shared.stopped) {
+		return {false, {}, shared.steps};
+	}
+	
+	return result;
+}
+
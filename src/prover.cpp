@@ -3,21 +3,73 @@
 #include <iostream>
 
 extern std::shared_ptr<Term> parse_term(const std::string&);
+extern std::shared_ptr<Formula> parse_formula_string(const std::string&);
 
-void Prover::start_interactive_proof(const std::shared_ptr<Formula>& formula_to_prove) {
-	Prover prover(formula_to_prove);
+void Prover::start_interactive_proof(const std::shared_ptr<Formula>& formula_to_prove, unsigned search_threads) {
+	Prover prover(formula_to_prove, false, search_threads);
 	prover.start();
 }
 
-Prover::Prover(const std::shared_ptr<Formula>& f)
-	:_formula_to_prove(f), _proof_state_manager(f)
+ScriptResult Prover::check_proof_script(const std::shared_ptr<Formula>& formula_to_prove, std::istream& script, bool verbose) {
+	Prover prover(formula_to_prove, true, 1);
+	
+	std::string line;
+	unsigned line_number = 0;
+	unsigned steps = 0;
+	
+	while (std::getline(script, line)) {
+		line_number++;
+		
+		Command command = Command::parse_command(line);
+		
+		if (command.type == CommandType::Empty) {
+			continue;
+		}
+		
+		steps++;
+		
+		prover._script_messages.str("");
+		
+		ExecuteStatus status = prover.execute(command);
+		
+		if (verbose) {
+			std::cout << "> " << line << std::endl;
+			std::cout << prover._script_messages.str();
+			std::cout << prover._proof_state_manager.to_string() << std::endl;
+		}
+		
+		if (status == ExecuteStatus::StopFailure) {
+			std::string message = prover._script_messages.str();
+			
+			if (!message.empty() and message.back() == '\n') {
+				message.pop_back();
+			}
+			
+			return {false, steps, "line " + std::to_string(line_number) + ": " + line + ": " + message};
+		}
+		
+		if (status == ExecuteStatus::StopSuccess) {
+			break;
+		}
+	}
+	
+	if (!prover._proof_state_manager.goals_solved()) {
+		return {false, steps, "proof script ended with unsolved goals"};
+	}
+	
+	return {true, steps, ""};
+}
+
+Prover::Prover(const std::shared_ptr<Formula>& f, bool script_mode, unsigned search_threads)
+	:_formula_to_prove(f), _proof_state_manager(f), _script_mode(script_mode), _search_threads(search_threads),
+	_messages(script_mode ? static_cast<std::ostream&>(_script_messages) : std::cout)
 {}
 
 void Prover::start() {
     print_intro_message();
 	
 	std::string user_input;
-
+	
 	while (true) {
 		std::cout << std::endl;
 		std::cout << _proof_state_manager.to_string() << std::endl;
@@ -49,20 +101,20 @@ ExecuteStatus Prover::execute(const Command& command) {
 		case CommandType::Empty:
 			return ExecuteStatus::Continue;
 		case CommandType::UnknownCommand:
-			std::cout << "Unknown command!" << std::endl;
-			return ExecuteStatus::Continue;
+			_messages << "Unknown command!" << std::endl;
+			return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
 		case CommandType::ListRequest:
-			std::cout << list_of_rules << std::endl;
+			_messages << list_of_rules << std::endl;
 			return ExecuteStatus::Continue;
 		case CommandType::HelpRequest:
-			std::cout << commands << std::endl;
+			_messages << commands << std::endl;
 			return ExecuteStatus::Continue;
 		case CommandType::ExitRequest:
 			return ExecuteStatus::StopSuccess;
 		case CommandType::Done:
 			if (!_proof_state_manager.goals_solved()) {
-				std::cout << "There are still goals to solve!" << std::endl;
-				return ExecuteStatus::Continue;
+				_messages << "There are still goals to solve!" << std::endl;
+				return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
 			}
 			
 			return ExecuteStatus::StopSuccess;
@@ -73,85 +125,186 @@ ExecuteStatus Prover::execute(const Command& command) {
 				throw std::logic_error("CommandType::RuleApplication requires a rule, but none was provided.");
 			}
 			
-			ManagerStatus manager_status = apply_rule(rule.value());
+			ProofStateManager previous_state = _proof_state_manager;
+			
+			ManagerStatus manager_status(ManagerStatusCode::Failure);
+			
+			try {
+				manager_status = apply_rule(rule.value(), command.argument, command.assumption);
+			} catch (const std::exception& e) {
+				_messages << e.what() << std::endl;
+				return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
+			}
 			
 			switch (manager_status.code) {
 				case ManagerStatusCode::Success:
-					break;
+					record_step(previous_state);
+					return ExecuteStatus::Continue;
 				case ManagerStatusCode::Failure:
-					std::cout << "Unable to apply rule to goal." << std::endl;
+					_messages << "Unable to apply rule to goal." << std::endl;
 					break;
 				case ManagerStatusCode::EmptyGoalList:
-					std::cout << "There are no goals to be solved." << std::endl;
+					_messages << "There are no goals to be solved." << std::endl;
 					break;
 			}
 			
-			return ExecuteStatus::Continue;
+			return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
 		}
-		case CommandType::Shift:
+		case CommandType::Shift: {
+			ProofStateManager previous_state = _proof_state_manager;
+			
 			ManagerStatus manager_status = _proof_state_manager.shift();
 			
 			if (manager_status.code == ManagerStatusCode::EmptyGoalList) {
-				std::cout << "There are no goals to apply shift to." << std::endl;
+				_messages << "There are no goals to apply shift to." << std::endl;
+				return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
+			}
+			
+			record_step(previous_state);
+			
+			return ExecuteStatus::Continue;
+		}
+		case CommandType::Undo:
+			if (_undo_history.empty()) {
+				_messages << "Nothing to undo." << std::endl;
+				return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
 			}
 			
+			_redo_history.push_back(_proof_state_manager);
+			_proof_state_manager = _undo_history.back();
+			_undo_history.pop_back();
+			
 			return ExecuteStatus::Continue;
+		case CommandType::Redo:
+			if (_redo_history.empty()) {
+				_messages << "Nothing to redo." << std::endl;
+				return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
+			}
+			
+			_undo_history.push_back(_proof_state_manager);
+			_proof_state_manager = _redo_history.back();
+			_redo_history.pop_back();
+			
+			return ExecuteStatus::Continue;
+		case CommandType::Checkpoint:
+			_checkpoints.insert_or_assign(command.argument, _proof_state_manager);
+			_messages << "Saved checkpoint '" << command.argument << "'." << std::endl;
+			return ExecuteStatus::Continue;
+		case CommandType::Restore: {
+			auto it = _checkpoints.find(command.argument);
+			
+			if (it == _checkpoints.end()) {
+				_messages << "No checkpoint named '" << command.argument << "'." << std::endl;
+				return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
+			}
+			
+			ProofStateManager previous_state = _proof_state_manager;
+			_proof_state_manager = it->second;
+			record_step(previous_state);
+			
+			return ExecuteStatus::Continue;
+		}
+		case CommandType::Auto:
+			return apply_auto(command.argument);
 	}
 	
 	return ExecuteStatus::StopFailure;
 }
 
-ManagerStatus Prover::apply_rule(const Rule& rule) {
-	switch (rule) {
-		case Rule::Assumption:
-			return _proof_state_manager.apply_assumption();
-		case Rule::NotI:
-			return _proof_state_manager.apply_rule_not_i();
-		case Rule::NotE:
-			return _proof_state_manager.apply_erule_not_e();
-		case Rule::ConjI:
-			return _proof_state_manager.apply_rule_conj_i();
-		case Rule::ConjE:
-			return _proof_state_manager.apply_erule_conj_e();
-		case Rule::DisjI1:
-			return _proof_state_manager.apply_rule_disj_i_1();
-		case Rule::DisjI2:
-			return _proof_state_manager.apply_rule_disj_i_2();
-		case Rule::DisjE:
-			return _proof_state_manager.apply_erule_disj_e();
-		case Rule::ImpI:
-			return _proof_state_manager.apply_rule_imp_i();
-		case Rule::ImpE:
-			return _proof_state_manager.apply_erule_imp_e();
-		case Rule::IffI:
-			return _proof_state_manager.apply_rule_iff_i();
-		case Rule::IffE:
-			return _proof_state_manager.apply_erule_iff_e();
-		case Rule::AllI:
-			return _proof_state_manager.apply_rule_all_i();
-		case Rule::AllE: {
-				std::shared_ptr<Term> term = get_term_from_user();
-				return _proof_state_manager.apply_erule_all_e(term);
-			}
-		case Rule::ExI: {
-				std::shared_ptr<Term> term = get_term_from_user();
-				return _proof_state_manager.apply_rule_ex_i(term);
-			}
-		case Rule::ExE:
-			return _proof_state_manager.apply_erule_ex_e();
-		case Rule::Ccontr:
-			return _proof_state_manager.apply_rule_ccontr();
-		case Rule::Classical:
-			return _proof_state_manager.apply_rule_classical();
+ManagerStatus Prover::apply_rule(const Rule& rule, const std::string& argument, const std::string& assumption) {
+	RuleApplication application = {rule};
+	
+	if (!assumption.empty()) {
+		application.assumption = get_assumption_position(assumption);
+	}
+	
+	if (rule == Rule::AllE or rule == Rule::ExI) {
+		application.terms.push_back(get_term(argument));
 	}
 	
-	return ManagerStatus(ManagerStatusCode::Failure);
+	return _proof_state_manager.apply(application);
+}
+
+// The found proof is applied only once all of it is known to solve the goals,
+// and then step by step, so each step can be undone on its own.
+ExecuteStatus Prover::apply_auto(const std::string& argument) {
+	SearchOptions options;
+	options.threads = _search_threads;
+	
+	if (!argument.empty()) {
+		if (argument.find_first_not_of("0123456789") != std::string::npos or argument.size() > 3) {
+			_messages << "Invalid search depth." << std::endl;
+			return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
+		}
+		
+		options.max_depth = std::stoul(argument);
+	}
+	
+	if (_proof_state_manager.goals_solved()) {
+		_messages << "There are no goals to be solved." << std::endl;
+		return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
+	}
+	
+	SearchResult result = search_proof(_proof_state_manager, options);
+	
+	if (!result.proved) {
+		_messages << "No proof found within depth " << options.max_depth << "." << std::endl;
+		return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
+	}
+	
+	// The state before every step and, last, the one after the proof.
+	std::vector<ProofStateManager> states = {_proof_state_manager};
+	
+	for (const auto& step : result.proof) {
+		auto next = states.back().successor(step.application);
+		
+		if (!next) {
+			break;
+		}
+		
+		states.push_back(std::move(*next));
+	}
+	
+	if (states.size() != result.proof.size() + 1 or !states.back().goals_solved()) {
+		_messages << "The proof found does not solve the goals." << std::endl;
+		return _script_mode ? ExecuteStatus::StopFailure : ExecuteStatus::Continue;
+	}
+	
+	_messages << "Proof found:" << std::endl;
+	
+	for (size_t i = 0; i < result.proof.size(); i++) {
+		_messages << result.proof[i].command << std::endl;
+		record_step(states[i]);
+	}
+	
+	_proof_state_manager = states.back();
+	
+	return ExecuteStatus::Continue;
+}
+
+// Called after the proof state changed: the previous state becomes undoable and
+// any undone steps are discarded.
+void Prover::record_step(const ProofStateManager& previous_state) {
+	_undo_history.push_back(previous_state);
+	_redo_history.clear();
+}
+
+std::shared_ptr<Term> Prover::get_term(const std::string& argument) {
+	if (!argument.empty()) {
+		return parse_term(argument);
+	}
+	
+	if (_script_mode) {
+		throw std::invalid_argument("Missing instantiation term.");
+	}
+	
+	return get_term_from_user();
 }
 
 std::shared_ptr<Term> Prover::get_term_from_user() {
 	std::string user_input;
     std::shared_ptr<Term> term;
-
+	
 	do {
 		std::cout << "Instantiate variable: ";
 		std::getline(std::cin, user_input);
@@ -165,3 +318,26 @@ std::shared_ptr<Term> Prover::get_term_from_user() {
 		}
 	} while (true);
 }
+
+std::optional<unsigned> Prover::get_assumption_position(const std::string& assumption) {
+	if (assumption.find_first_not_of("0123456789") == std::string::npos) {
+		if (assumption.size() > 9 or std::stoul(assumption) == 0) {
+			throw std::invalid_argument("Assumptions are numbered from 1.");
+		}
+		
+		return std::stoul(assumption) - 1;
+	}
+	
+	if (_proof_state_manager.goals_solved()) {
+		return std::nullopt;
+	}
+	
+	auto position = _proof_state_manager.current_goal().get_assumption_position(parse_formula_string(assumption));
+	
+	if (!position) {
+		throw std::invalid_argument("No such assumption in the current goal.");
+	}
+	
+	return position;
+}
+
@@ -0,0 +1,278 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <algorithm>
+
+#include "formula.hpp"
+#include "prover.hpp"
+#include "thread_pool.hpp"
+#include "fast_parser.hpp"
+
+extern std::shared_ptr<Formula> parse_formula(const std::string& filename);
+
+namespace {
+
+enum class CheckStatus {
+	Proved,
+	Failed,
+	Error
+};
+
+struct CheckJob {
+	std::string formula_path;
+	std::string script_path;
+	CheckStatus status = CheckStatus::Error;
+	unsigned steps = 0;
+	double time_ms = 0;
+	std::string error = "";
+};
+
+std::string status_name(CheckStatus status) {
+	switch (status) {
+		case CheckStatus::Proved:
+			return "proved";
+		case CheckStatus::Failed:
+			return "failed";
+		default:
+			return "error";
+	}
+}
+
+std::string json_string(const std::string& s) {
+	std::stringstream out;
+	
+	out << '"';
+	
+	for (char c : s) {
+		switch (c) {
+			case '"':
+				out << "\\\"";
+				break;
+			case '\\':
+				out << "\\\\";
+				break;
+			case '\n':
+				out << "\\n";
+				break;
+			case '\t':
+				out << "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+					out << escaped;
+				} else {
+					out << c;
+				}
+		}
+	}
+	
+	out << '"';
+	
+	return out.str();
+}
+
+// Paths in the manifest are relative to the manifest itself.
+std::string resolve_path(const std::string& directory, const std::string& path) {
+	if (directory.empty() or path.front() == '/') {
+		return path;
+	}
+	
+	return directory + "/" + path;
+}
+
+std::vector<CheckJob> read_manifest(const std::string& manifest_path) {
+	std::ifstream manifest(manifest_path);
+	
+	if (!manifest) {
+		throw std::runtime_error("Error opening file: " + manifest_path);
+	}
+	
+	size_t slash = manifest_path.rfind('/');
+	std::string directory = slash == std::string::npos ? "" : manifest_path.substr(0, slash);
+	
+	std::vector<CheckJob> jobs;
+	std::string line;
+	unsigned line_number = 0;
+	
+	while (std::getline(manifest, line)) {
+		line_number++;
+		
+		std::istringstream words(line);
+		std::string formula_path;
+		std::string script_path;
+		std::string rest;
+		
+		if (!(words >> formula_path) or formula_path.front() == '#') {
+			continue;
+		}
+		
+		if (!(words >> script_path) or (words >> rest)) {
+			throw std::runtime_error(manifest_path + ":" + std::to_string(line_number) + ": expected <formula> <script>");
+		}
+		
+		CheckJob job;
+		job.formula_path = resolve_path(directory, formula_path);
+		job.script_path = resolve_path(directory, script_path);
+		jobs.push_back(job);
+	}
+	
+	return jobs;
+}
+
+void run_job(CheckJob& job, bool fast_parser) {
+	auto start = std::chrono::steady_clock::now();
+	
+	try {
+		std::shared_ptr<Formula> formula = fast_parser ? fast_parse_formula_file(job.formula_path) : parse_formula(job.formula_path);
+		
+		std::ifstream script(job.script_path);
+		
+		if (!script) {
+			throw std::runtime_error("Error opening file: " + job.script_path);
+		}
+		
+		ScriptResult result = Prover::check_proof_script(formula, script, false);
+		
+		job.status = result.proved ? CheckStatus::Proved : CheckStatus::Failed;
+		job.steps = result.steps;
+		job.error = result.error;
+	} catch (const std::exception& e) {
+		job.status = CheckStatus::Error;
+		job.error = e.what();
+	}
+	
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	job.time_ms = elapsed.count();
+}
+
+void write_summary(std::ostream& out, const std::vector<CheckJob>& jobs, unsigned threads, double time_ms) {
+	size_t proved = 0;
+	
+	for (const auto& job : jobs) {
+		if (job.status == CheckStatus::Proved) {
+			proved++;
+		}
+	}
+	
+	out << "{\n";
+	out << "  \"total\": " << jobs.size() << ",\n";
+	out << "  \"proved\": " << proved << ",\n";
+	out << "  \"failed\": " << jobs.size() - proved << ",\n";
+	out << "  \"threads\": " << threads << ",\n";
+	out << "  \"time_ms\": " << time_ms << ",\n";
+	out << "  \"results\": [";
+	
+	for (size_t i = 0; i < jobs.size(); i++) {
+		const CheckJob& job = jobs[i];
+		
+		out << (i == 0 ? "\n" : ",\n");
+		out << "    {\"formula\": " << json_string(job.formula_path);
+		out << ", \"script\": " << json_string(job.script_path);
+		out << ", \"status\": " << json_string(status_name(job.status));
+		out << ", \"steps\": " << job.steps;
+		out << ", \"time_ms\": " << job.time_ms;
+		out << ", \"error\": " << json_string(job.error) << "}";
+	}
+	
+	out << (jobs.empty() ? "]\n" : "\n  ]\n");
+	out << "}\n";
+}
+
+// The argument of -j: a positive number of threads.
+unsigned parse_threads(const std::string& argument, const std::string& usage) {
+	if (argument.empty() or argument.size() > 9 or argument.find_first_not_of("0123456789") != std::string::npos) {
+		throw std::invalid_argument(usage);
+	}
+	
+	unsigned threads = std::stoul(argument);
+	
+	if (threads == 0) {
+		throw std::invalid_argument(usage);
+	}
+	
+	return threads;
+}
+
+}
+
+int main(int argc, char** argv) {
+	try {
+		std::string usage = std::string("Usage: ") + argv[0] + " [-j <threads>] [-o <summary_path>] [--fast-parser] <manifest>";
+		
+		// hardware_concurrency() is 0 when the count is unknown.
+		unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+		std::string summary_path;
+		std::string manifest_path;
+		bool fast_parser = false;
+		
+		for (int i = 1; i < argc; i++) {
+			std::string argument = argv[i];
+			
+			if ((argument == "-j" or argument == "-o") and i + 1 == argc) {
+				throw std::invalid_argument(usage);
+			}
+			
+			if (argument == "-j") {
+				threads = parse_threads(argv[++i], usage);
+			} else if (argument == "-o") {
+				summary_path = argv[++i];
+			} else if (argument == "--fast-parser") {
+				fast_parser = true;
+			} else if (manifest_path.empty()) {
+				manifest_path = argument;
+			} else {
+				throw std::invalid_argument(usage);
+			}
+		}
+		
+		if (manifest_path.empty()) {
+			throw std::invalid_argument(usage);
+		}
+		
+		std::vector<CheckJob> jobs = read_manifest(manifest_path);
+		
+		auto start = std::chrono::steady_clock::now();
+		
+		WorkStealingPool pool(threads);
+		
+		for (auto& job : jobs) {
+			pool.submit([&job, fast_parser] { run_job(job, fast_parser); });
+		}
+		
+		pool.wait();
+		
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		
+		if (summary_path.empty()) {
+			write_summary(std::cout, jobs, pool.thread_count(), elapsed.count());
+		} else {
+			std::ofstream summary(summary_path);
+			
+			if (!summary) {
+				throw std::runtime_error("Error opening file: " + summary_path);
+			}
+			
+			write_summary(summary, jobs, pool.thread_count(), elapsed.count());
+		}
+		
+		for (const auto& job : jobs) {
+			if (job.status != CheckStatus::Proved) {
+				return 2;
+			}
+		}
+		
+		return 0;
+	} catch (const std::exception& e) {
+		std::cerr << "Error:" << std::endl;
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
+
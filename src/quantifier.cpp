@@ -1,18 +1,57 @@
 #include "quantifier.hpp"
+#include "node_factory.hpp"
+#include "substitution.hpp"
 
-std::string Quantifier::to_string() const {
-	std::string sub;
+Quantifier::Quantifier(FormulaType type, const Symbol& var, const std::shared_ptr<Formula>& sub)
+	:_variable_name(var), _subformula(sub)
+{
+	_variable_names = sub->get_variable_names();
+	_variable_names.insert(var);
+	_free_variable_names = sub->get_free_variable_names();
+	_size = sub->size() + 1;
+	_depth = sub->depth() + 1;
+	_hash = hash_combine(static_cast<size_t>(type), sub->hash());
+	_sequent_hash = sequent_hash_combine(sequent_hash_seed(static_cast<uint64_t>(type)), sub->sequent_hash());
+	_loose_depth = sub->loose_depth() > 0 ? sub->loose_depth() - 1 : 0;
+}
 
+std::string Quantifier::format(const BinderNames& binders) const {
+	Symbol name = display_name(binders);
+	
+	BinderNames inner_binders = binders;
+	inner_binders.push_back(name);
+	
+	std::string sub;
+	
 	if (_subformula->requires_parentheses()) {
-		sub = "(" + _subformula->to_string() + ")";
+		sub = "(" + _subformula->format(inner_binders) + ")";
 	} else {
-		sub = _subformula->to_string();
+		sub = _subformula->format(inner_binders);
 	}
 	
-	return symbol() + _variable_name + ". " + sub;
+	return symbol() + name.name() + ". " + sub;
 }
 
-std::string Quantifier::get_variable_name() const {
+Symbol Quantifier::display_name(const BinderNames& binders) const {
+	const auto& free_variables = _subformula->get_free_variable_names();
+	unsigned referenced_binders = _subformula->loose_depth();
+	
+	return Formula::generate_new_variable_name(_variable_name, [&](const Symbol& name) {
+		if (free_variables.contains(name)) {
+			return true;
+		}
+		
+		for (unsigned i = 1; i < referenced_binders and i <= binders.size(); i++) {
+			if (binders[binders.size() - i] == name) {
+				return true;
+			}
+		}
+		
+		return false;
+	});
+}
+
+Symbol Quantifier::get_variable_name() const {
 	return _variable_name;
 }
 
@@ -20,20 +59,29 @@ std::shared_ptr<Formula> Quantifier::get_subformula() const {
 	return _subformula;
 }
 
-std::set<std::string> Quantifier::get_variable_names() const {
-	auto sub_vars = _subformula->get_variable_names();
-	
-	sub_vars.insert(_variable_name);
-	
-	return sub_vars;
+std::shared_ptr<Formula> Quantifier::instantiate(const std::shared_ptr<Term>& term) const {
+	return _subformula->instantiate_bound(0, {term});
 }
 
-std::set<std::string> Quantifier::get_free_variable_names() const {
-	auto sub_vars = _subformula->get_free_variable_names();
+std::shared_ptr<Formula> Quantifier::instantiate(const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (terms.empty()) {
+		return nullptr;
+	}
+	
+	std::shared_ptr<Formula> scope = _subformula;
+	
+	for (size_t i = 1; i < terms.size(); i++) {
+		if (scope->type() != type()) {
+			return nullptr;
+		}
+		
+		scope = std::static_pointer_cast<Quantifier>(scope)->_subformula;
+	}
 	
-	sub_vars.erase(_variable_name);
+	// The innermost stripped quantifier binds index 0.
+	std::vector<std::shared_ptr<Term>> bound_terms(terms.rbegin(), terms.rend());
 	
-	return sub_vars;
+	return scope->instantiate_bound(0, bound_terms);
 }
 
 bool Quantifier::requires_parentheses() const {
@@ -49,72 +97,31 @@ FormulaType ForAll::type() const {
 }
 
 bool ForAll::operator==(const ForAll& other) const {
-	return this->_variable_name == other._variable_name and are_equal(this->_subformula, other._subformula);
+	return are_equal(this->_subformula, other._subformula);
 }
 
-std::shared_ptr<Formula> ForAll::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
-	if (_variable_name == var_name) {
-		return std::make_shared<ForAll>(*this);
+std::shared_ptr<Formula> ForAll::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_free_variable_names)) {
+		return self();
 	}
 	
-	auto term_variables = term->get_variable_names();
-	
-	if (term_variables.find(_variable_name) == term_variables.end()) {
-		return std::make_shared<ForAll>(_variable_name, _subformula->replace(var_name, term));
-	}
-	
-	auto used_variables = _subformula->get_variable_names();
-	used_variables.insert(term_variables.begin(), term_variables.end());
-	
-	std::string new_variable_name = Formula::generate_new_variable_name(_variable_name, used_variables);
-	
-	auto alpha_converted = this->alpha_convert(new_variable_name);
-	
-	return alpha_converted->replace(var_name, term);
+	return NodeFactory::make_for_all_scope(_variable_name, _subformula->substitute(substitution));
 }
 
-std::shared_ptr<Formula> ForAll::rename_var(const std::string& old_name, const std::string& new_name) const {
-	if (_variable_name == old_name or _variable_name == new_name) {
-		return std::make_shared<ForAll>(*this);
+std::shared_ptr<Formula> ForAll::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_free_variable_names.contains(var_name)) {
+		return self();
 	}
 	
-	return std::make_shared<ForAll>(_variable_name, _subformula->rename_var(old_name, new_name));
+	return NodeFactory::make_for_all_scope(_variable_name, _subformula->abstract_var(var_name, index + 1));
 }
 
-std::shared_ptr<Quantifier> ForAll::alpha_convert() const {
-	std::string old_var_name = _variable_name;
-	std::string new_var_name;
-	
-	auto subformula_var_names = _subformula->get_variable_names();
-	
-	unsigned i = 1;
-	while (true) {
-		new_var_name = old_var_name + std::to_string(i);
-		
-		if (subformula_var_names.find(new_var_name) == subformula_var_names.end()) {
-			break;
-		}
-		
-		i++;
+std::shared_ptr<Formula> ForAll::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
 	}
 	
-	auto new_subformula = _subformula->rename_var(old_var_name, new_var_name);
-	
-	return std::make_shared<ForAll>(new_var_name, new_subformula);
-}
-
-std::shared_ptr<Quantifier> ForAll::alpha_convert(const std::string& new_var_name) const {
-	std::string old_var_name = _variable_name;
-	
-	auto subformula_var_names = _subformula->get_variable_names();
-	
-	if (subformula_var_names.find(new_var_name) != subformula_var_names.end()) {
-		throw std::runtime_error("Can't preform alpha conversion - variable in use!");
-	}
-	
-	auto new_subformula = _subformula->rename_var(old_var_name, new_var_name);
-	
-	return std::make_shared<ForAll>(new_var_name, new_subformula);
+	return NodeFactory::make_for_all_scope(_variable_name, _subformula->instantiate_bound(index + 1, terms));
 }
 
 std::string Exists::symbol() const {
@@ -126,71 +133,30 @@ FormulaType Exists::type() const {
 }
 
 bool Exists::operator==(const Exists& other) const {
-	return this->_variable_name == other._variable_name and are_equal(this->_subformula, other._subformula);
+	return are_equal(this->_subformula, other._subformula);
 }
 
-std::shared_ptr<Formula> Exists::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
-	if (_variable_name == var_name) {
-		return std::make_shared<Exists>(*this);
+std::shared_ptr<Formula> Exists::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_free_variable_names)) {
+		return self();
 	}
 	
-	auto term_variables = term->get_variable_names();
-	
-	if (term_variables.find(_variable_name) == term_variables.end()) {
-		return std::make_shared<Exists>(_variable_name, _subformula->replace(var_name, term));
-	}
-	
-	auto used_variables = _subformula->get_variable_names();
-	used_variables.insert(term_variables.begin(), term_variables.end());
-	
-	std::string new_variable_name = Formula::generate_new_variable_name(_variable_name, used_variables);
-	
-	auto alpha_converted = this->alpha_convert(new_variable_name);
-	
-	return alpha_converted->replace(var_name, term);
+	return NodeFactory::make_exists_scope(_variable_name, _subformula->substitute(substitution));
 }
 
-std::shared_ptr<Formula> Exists::rename_var(const std::string& old_name, const std::string& new_name) const {
-	if (_variable_name == old_name or _variable_name == new_name) {
-		return std::make_shared<Exists>(*this);
-	}
-	
-	return std::make_shared<Exists>(_variable_name, _subformula->rename_var(old_name, new_name));
-}
-
-std::shared_ptr<Quantifier> Exists::alpha_convert() const {
-	std::string old_var_name = _variable_name;
-	std::string new_var_name;
-	
-	auto subformula_var_names = _subformula->get_variable_names();
-	
-	unsigned i = 1;
-	while (true) {
-		new_var_name = old_var_name + std::to_string(i);
-		
-		if (subformula_var_names.find(new_var_name) == subformula_var_names.end()) {
-			break;
-		}
-		
-		i++;
+std::shared_ptr<Formula> Exists::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_free_variable_names.contains(var_name)) {
+		return self();
 	}
 	
-	auto new_subformula = _subformula->rename_var(old_var_name, new_var_name);
-	
-	return std::make_shared<Exists>(new_var_name, new_subformula);
+	return NodeFactory::make_exists_scope(_variable_name, _subformula->abstract_var(var_name, index + 1));
 }
 
-std::shared_ptr<Quantifier> Exists::alpha_convert(const std::string& new_var_name) const {
-	std::string old_var_name = _variable_name;
-	
-	auto subformula_var_names = _subformula->get_variable_names();
-	
-	if (subformula_var_names.find(new_var_name) != subformula_var_names.end()) {
-		throw std::runtime_error("Can't preform alpha conversion - variable in use!");
+std::shared_ptr<Formula> Exists::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
 	}
 	
-	auto new_subformula = _subformula->rename_var(old_var_name, new_var_name);
-	
-	return std::make_shared<Exists>(new_var_name, new_subformula);
+	return NodeFactory::make_exists_scope(_variable_name, _subformula->instantiate_bound(index + 1, terms));
 }
 
@@ -0,0 +1,106 @@
+#include "sequent_hash.hpp"
+#include "atom.hpp"
+#include "connective.hpp"
+#include "quantifier.hpp"
+
+namespace {
+
+const uint64_t numbered_variable_kind = 0x100;
+
+// Recomputes the hashes the nodes cache, with numbered variables in place of
+// their names. Subtrees without free variables keep their cached hash.
+class FormulaHasher {
+	public:
+		FormulaHasher(const VariableNumbering& numbering)
+			:_numbering(numbering)
+		{}
+		
+		SequentHash formula(const Formula& formula) {
+			if (formula.get_free_variable_names().empty()) {
+				return formula.sequent_hash();
+			}
+			
+			FormulaType type = formula.type();
+			SequentHash hash = sequent_hash_seed(static_cast<uint64_t>(type));
+			
+			switch (type) {
+				case FormulaType::ComplexAtom: {
+					const auto& atom = static_cast<const ComplexAtom&>(formula);
+					
+					hash = sequent_hash_combine(hash, atom.get_predicate_symbol().id());
+					hash = sequent_hash_combine(hash, atom.get_terms().size());
+					
+					for (const auto& t : atom.get_terms()) {
+						hash = sequent_hash_combine(hash, term(*t));
+					}
+					return hash;
+				}
+				case FormulaType::Negation:
+					return sequent_hash_combine(hash, this->formula(*static_cast<const Negation&>(formula).get_subformula()));
+				case FormulaType::Conjunction:
+				case FormulaType::Disjunction:
+				case FormulaType::Implication:
+				case FormulaType::Equivalence: {
+					const auto& connective = static_cast<const BinaryConnective&>(formula);
+					
+					hash = sequent_hash_combine(hash, this->formula(*connective.get_left_subformula()));
+					return sequent_hash_combine(hash, this->formula(*connective.get_right_subformula()));
+				}
+				case FormulaType::ForAll:
+				case FormulaType::Exists:
+					return sequent_hash_combine(hash, this->formula(*static_cast<const Quantifier&>(formula).get_subformula()));
+				default:
+					return formula.sequent_hash();
+			}
+		}
+	private:
+		SequentHash term(const Term& term) {
+			if (term.get_variable_names().empty()) {
+				return term.sequent_hash();
+			}
+			
+			TermType type = term.type();
+			
+			switch (type) {
+				case TermType::Variable: {
+					std::optional<unsigned> number = _numbering(static_cast<const Variable&>(term).get_name());
+					
+					if (!number) {
+						return term.sequent_hash();
+					}
+					
+					return sequent_hash_combine(sequent_hash_seed(numbered_variable_kind), *number);
+				}
+				case TermType::ComplexTerm: {
+					const auto& complex_term = static_cast<const ComplexTerm&>(term);
+					SequentHash hash = sequent_hash_seed(static_cast<uint64_t>(type));
+					
+					hash = sequent_hash_combine(hash, complex_term.get_function_symbol().id());
+					hash = sequent_hash_combine(hash, complex_term.get_subterms().size());
+					
+					for (const auto& t : complex_term.get_subterms()) {
+						hash = sequent_hash_combine(hash, this->term(*t));
+					}
+					return hash;
+				}
+				default:
+					return term.sequent_hash();
+			}
+		}
+	private:
+		const VariableNumbering& _numbering;
+};
+
+}
+
+SequentHash hash_formula(const Formula& formula, const VariableNumbering& numbering) {
+	if (!numbering) {
+		return formula.sequent_hash();
+	}
+	
+	return FormulaHasher(numbering).formula(formula);
+}
+
+SequentHash tag_hash(const SequentHash& hash, uint64_t tag) {
+	return {hash_mix(hash.low ^ hash_mix(tag)), hash_mix(hash.high + hash_mix(tag + 1))};
+}
@@ -0,0 +1,34 @@
+#include "substitution.hpp"
+
+Substitution::Substitution(std::initializer_list<std::pair<const Symbol, std::shared_ptr<Term>>> bindings)
+	:_bindings(bindings)
+{}
+
+void Substitution::bind(const Symbol& var_name, const std::shared_ptr<Term>& term) {
+	_bindings[var_name] = term;
+}
+
+std::shared_ptr<Term> Substitution::find(const Symbol& var_name) const {
+	auto it = _bindings.find(var_name);
+	
+	if (it == _bindings.end()) {
+		return nullptr;
+	}
+	
+	return it->second;
+}
+
+bool Substitution::affects(const VariableSet& variables) const {
+	for (const auto& binding : _bindings) {
+		if (variables.contains(binding.first)) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+bool Substitution::empty() const {
+	return _bindings.empty();
+}
+
@@ -0,0 +1,60 @@
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+
+#include "symbol.hpp"
+
+namespace {
+
+// Names are only ever appended, and deque keeps references to its elements
+// valid, so a name can be used after the lock protecting the lookup is released.
+struct SymbolTable {
+	std::shared_mutex mutex;
+	std::deque<std::string> names;
+	std::unordered_map<std::string, unsigned> ids;
+};
+
+SymbolTable& symbol_table() {
+	static SymbolTable* table = new SymbolTable();
+	return *table;
+}
+
+}
+
+Symbol::Symbol(const std::string& name) {
+	SymbolTable& table = symbol_table();
+	
+	{
+		std::shared_lock<std::shared_mutex> lock(table.mutex);
+		
+		auto it = table.ids.find(name);
+		
+		if (it != table.ids.end()) {
+			_id = it->second;
+			return;
+		}
+	}
+	
+	std::unique_lock<std::shared_mutex> lock(table.mutex);
+	
+	auto it = table.ids.find(name);
+	
+	if (it != table.ids.end()) {
+		_id = it->second;
+		return;
+	}
+	
+	_id = table.names.size();
+	table.names.push_back(name);
+	table.ids.emplace(name, _id);
+}
+
+const std::string& Symbol::name() const {
+	SymbolTable& table = symbol_table();
+	
+	std::shared_lock<std::shared_mutex> lock(table.mutex);
+	
+	return table.names[_id];
+}
+
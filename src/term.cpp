@@ -1,33 +1,12 @@
 #include <sstream>
+#include <algorithm>
 
 #include "term.hpp"
+#include "node_factory.hpp"
+#include "substitution.hpp"
 
 bool are_equal(const std::shared_ptr<Term>& t1, const std::shared_ptr<Term>& t2) {
-	TermType type = t1->type();
-
-	if (type != t2->type()) {
-		return false;
-	}
-	
-	switch (type) {
-		case TermType::Variable: {
-			auto v1 = std::dynamic_pointer_cast<Variable>(t1);
-			auto v2 = std::dynamic_pointer_cast<Variable>(t2);
-			return *v1 == *v2;
-		}
-		case TermType::Constant: {
-			auto c1 = std::dynamic_pointer_cast<Constant>(t1);
-			auto c2 = std::dynamic_pointer_cast<Constant>(t2);
-			return *c1 == *c2;
-		}
-		case TermType::ComplexTerm: {
-			auto ct1 = std::dynamic_pointer_cast<ComplexTerm>(t1);
-			auto ct2 = std::dynamic_pointer_cast<ComplexTerm>(t2);
-			return *ct1 == *ct2;
-		}
-	}
-
-	return false;
+	return t1 == t2;
 }
 
 std::ostream& operator<<(std::ostream& out, const Term& term) {
@@ -35,8 +14,58 @@ std::ostream& operator<<(std::ostream& out, const Term& term) {
 	return out;
 }
 
-std::string Variable::to_string() const {
-	return _name;
+std::string Term::to_string() const {
+	return format({});
+}
+
+std::shared_ptr<Term> Term::replace(const Symbol& var_name, const std::shared_ptr<Term>& term) const {
+	return substitute({{var_name, term}});
+}
+
+std::shared_ptr<Term> Term::rename_var(const Symbol& old_name, const Symbol& new_name) const {
+	return substitute({{old_name, NodeFactory::make_variable(new_name)}});
+}
+
+const VariableSet& Term::get_variable_names() const {
+	return _variable_names;
+}
+
+unsigned Term::size() const {
+	return _size;
+}
+
+unsigned Term::depth() const {
+	return _depth;
+}
+
+size_t Term::hash() const {
+	return _hash;
+}
+
+const SequentHash& Term::sequent_hash() const {
+	return _sequent_hash;
+}
+
+unsigned Term::loose_depth() const {
+	return _loose_depth;
+}
+
+// Nodes are immutable once built, so handing out a mutable pointer is safe.
+std::shared_ptr<Term> Term::self() const {
+	return std::const_pointer_cast<Term>(shared_from_this());
+}
+
+Variable::Variable(const Symbol& name)
+	:_name(name)
+{
+	_variable_names = {name};
+	_hash = hash_combine(static_cast<size_t>(TermType::Variable), name.id());
+	_sequent_hash = sequent_hash_combine(sequent_hash_seed(static_cast<uint64_t>(TermType::Variable)), name.id());
+}
+
+std::string Variable::format(const BinderNames& binders) const {
+	(void) binders;
+	return _name.name();
 }
 
 TermType Variable::type() const {
@@ -47,31 +76,95 @@ bool Variable::operator==(const Variable& other) const {
 	return this->_name == other._name;
 }
 
-std::set<std::string> Variable::get_variable_names() const {
-	return {_name};
+Symbol Variable::get_name() const {
+	return _name;
 }
 
-std::shared_ptr<Term> Variable::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
-	if (_name == var_name) {
+std::shared_ptr<Term> Variable::substitute(const Substitution& substitution) const {
+	auto term = substitution.find(_name);
+	
+	if (term) {
 		return term;
 	} else {
-		return std::make_shared<Variable>(*this);
+		return self();
+	}
+}
+
+std::shared_ptr<Term> Variable::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (_name == var_name) {
+		return NodeFactory::make_bound_variable(index);
+	}
+	
+	return self();
+}
+
+std::shared_ptr<Term> Variable::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	(void) index;
+	(void) terms;
+	return self();
+}
+
+BoundVariable::BoundVariable(unsigned index)
+	:_index(index)
+{
+	_hash = hash_combine(static_cast<size_t>(TermType::BoundVariable), index);
+	_sequent_hash = sequent_hash_combine(sequent_hash_seed(static_cast<uint64_t>(TermType::BoundVariable)), index);
+	_loose_depth = index + 1;
+}
+
+std::string BoundVariable::format(const BinderNames& binders) const {
+	if (_index >= binders.size()) {
+		return "#" + std::to_string(_index);
 	}
+	
+	return binders[binders.size() - 1 - _index].name();
+}
+
+TermType BoundVariable::type() const {
+	return TermType::BoundVariable;
+}
+
+bool BoundVariable::operator==(const BoundVariable& other) const {
+	return this->_index == other._index;
+}
+
+unsigned BoundVariable::get_index() const {
+	return _index;
 }
 
-std::shared_ptr<Term> Variable::rename_var(const std::string& old_name, const std::string& new_name) const {
-	auto var = std::make_shared<Variable>(*this);
+std::shared_ptr<Term> BoundVariable::substitute(const Substitution& substitution) const {
+	(void) substitution;
+	return self();
+}
+
+std::shared_ptr<Term> BoundVariable::abstract_var(const Symbol& var_name, unsigned index) const {
+	(void) var_name;
+	(void) index;
+	return self();
+}
+
+std::shared_ptr<Term> BoundVariable::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_index < index) {
+		return self();
+	}
 	
-	if (_name == old_name) {
-		var->_name = new_name;
-		return var;
+	if (_index - index < terms.size()) {
+		return terms[_index - index];
 	}
 	
-	return var;
+	return NodeFactory::make_bound_variable(_index - terms.size());
 }
 
-std::string Constant::to_string() const {
-	return _name;
+Constant::Constant(const Symbol& name)
+	:_name(name)
+{
+	_hash = hash_combine(static_cast<size_t>(TermType::Constant), name.id());
+	_sequent_hash = sequent_hash_combine(sequent_hash_seed(static_cast<uint64_t>(TermType::Constant)), name.id());
+}
+
+std::string Constant::format(const BinderNames& binders) const {
+	(void) binders;
+	return _name.name();
 }
 
 TermType Constant::type() const {
@@ -82,31 +175,58 @@ bool Constant::operator==(const Constant& other) const {
 	return this->_name == other._name;
 }
 
-std::set<std::string> Constant::get_variable_names() const {
-	return {};
+Symbol Constant::get_name() const {
+	return _name;
 }
 
-std::shared_ptr<Term> Constant::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
+std::shared_ptr<Term> Constant::substitute(const Substitution& substitution) const {
+	(void) substitution;
+	return self();
+}
+
+std::shared_ptr<Term> Constant::abstract_var(const Symbol& var_name, unsigned index) const {
 	(void) var_name;
-	(void) term;
-	return std::make_shared<Constant>(*this);
+	(void) index;
+	return self();
 }
 
-std::shared_ptr<Term> Constant::rename_var(const std::string& old_name, const std::string& new_name) const {
-	(void) old_name;
-	(void) new_name;
-	return std::make_shared<Constant>(*this);
+std::shared_ptr<Term> Constant::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	(void) index;
+	(void) terms;
+	return self();
 }
 
-std::string ComplexTerm::to_string() const {
+ComplexTerm::ComplexTerm(const Symbol& f, const std::vector<std::shared_ptr<Term>>& terms)
+	:_function_symbol(f), _subterms(terms)
+{
+	_hash = hash_combine(static_cast<size_t>(TermType::ComplexTerm), f.id());
+	_sequent_hash = sequent_hash_seed(static_cast<uint64_t>(TermType::ComplexTerm));
+	_sequent_hash = sequent_hash_combine(_sequent_hash, f.id());
+	_sequent_hash = sequent_hash_combine(_sequent_hash, _subterms.size());
+	
+	std::vector<Symbol> variables;
+	
+	for (const auto& t : _subterms) {
+		variables.insert(variables.end(), t->get_variable_names().begin(), t->get_variable_names().end());
+		_size += t->size();
+		_depth = std::max(_depth, t->depth() + 1);
+		_hash = hash_combine(_hash, t->hash());
+		_sequent_hash = sequent_hash_combine(_sequent_hash, t->sequent_hash());
+		_loose_depth = std::max(_loose_depth, t->loose_depth());
+	}
+	
+	_variable_names = VariableSet(std::move(variables));
+}
+
+std::string ComplexTerm::format(const BinderNames& binders) const {
 	std::stringstream s;
 	
-	s << _function_symbol;
+	s << _function_symbol.name();
 	
 	s << "(";
 	
 	for (size_t i = 0; i < _subterms.size(); i++) {
-		s << _subterms[i]->to_string();
+		s << _subterms[i]->format(binders);
 		if (i < _subterms.size() - 1) {
 			s << ", ";
 		}
@@ -121,6 +241,14 @@ TermType ComplexTerm::type() const {
 	return TermType::ComplexTerm;
 }
 
+Symbol ComplexTerm::get_function_symbol() const {
+	return _function_symbol;
+}
+
+const std::vector<std::shared_ptr<Term>>& ComplexTerm::get_subterms() const {
+	return _subterms;
+}
+
 bool ComplexTerm::operator==(const ComplexTerm& other) const {
 	if (this->_function_symbol != other._function_symbol) {
 		return false;
@@ -139,34 +267,45 @@ bool ComplexTerm::operator==(const ComplexTerm& other) const {
 	return true;
 }
 
-std::set<std::string> ComplexTerm::get_variable_names() const {
-	std::set<std::string> variable_names = {};
-
+std::shared_ptr<Term> ComplexTerm::substitute(const Substitution& substitution) const {
+	if (!substitution.affects(_variable_names)) {
+		return self();
+	}
+	
+	std::vector<std::shared_ptr<Term>> new_subterms = {};
+	
 	for (const auto& t : _subterms) {
-		auto sub_vars = t->get_variable_names();
-		variable_names.insert(sub_vars.begin(), sub_vars.end());
+		new_subterms.push_back(t->substitute(substitution));
 	}
 	
-	return variable_names;
+	return NodeFactory::make_complex_term(_function_symbol, new_subterms);
 }
 
-std::shared_ptr<Term> ComplexTerm::replace(const std::string& var_name, const std::shared_ptr<Term>& term) const {
+std::shared_ptr<Term> ComplexTerm::abstract_var(const Symbol& var_name, unsigned index) const {
+	if (!_variable_names.contains(var_name)) {
+		return self();
+	}
+	
 	std::vector<std::shared_ptr<Term>> new_subterms = {};
 	
 	for (const auto& t : _subterms) {
-		new_subterms.push_back(t->replace(var_name, term));
+		new_subterms.push_back(t->abstract_var(var_name, index));
 	}
 	
-	return std::make_shared<ComplexTerm>(_function_symbol, new_subterms);
+	return NodeFactory::make_complex_term(_function_symbol, new_subterms);
 }
 
-std::shared_ptr<Term> ComplexTerm::rename_var(const std::string& old_name, const std::string& new_name) const {
+std::shared_ptr<Term> ComplexTerm::instantiate_bound(unsigned index, const std::vector<std::shared_ptr<Term>>& terms) const {
+	if (_loose_depth <= index) {
+		return self();
+	}
+	
 	std::vector<std::shared_ptr<Term>> new_subterms = {};
 	
 	for (const auto& t : _subterms) {
-		new_subterms.push_back(t->rename_var(old_name, new_name));
+		new_subterms.push_back(t->instantiate_bound(index, terms));
 	}
 	
-	return std::make_shared<ComplexTerm>(_function_symbol, new_subterms);
+	return NodeFactory::make_complex_term(_function_symbol, new_subterms);
 }
 
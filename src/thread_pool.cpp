@@ -0,0 +1,177 @@
+#include "thread_pool.hpp"
+
+namespace {
+
+thread_local const WorkStealingPool* current_pool = nullptr;
+thread_local unsigned current_worker = 0;
+
+}
+
+WorkStealingPool::WorkStealingPool(unsigned thread_count) {
+	if (thread_count == 0) {
+		thread_count = 1;
+	}
+	
+	for (unsigned i = 0; i < thread_count; i++) {
+		_queues.push_back(std::make_unique<Queue>());
+	}
+	
+	for (unsigned i = 0; i < thread_count; i++) {
+		_threads.emplace_back(&WorkStealingPool::run, this, i);
+	}
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	
+	_task_queued.notify_all();
+	
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+	unsigned index;
+	
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		
+		if (current_pool == this) {
+			index = current_worker;
+		} else {
+			index = _next_queue;
+			_next_queue = (_next_queue + 1) % _queues.size();
+		}
+		
+		_unfinished++;
+	}
+	
+	{
+		std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+		_queues[index]->tasks.push_back(std::move(task));
+	}
+	
+	bool helpers;
+	
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_queued++;
+		helpers = _helpers > 0;
+	}
+	
+	_task_queued.notify_one();
+	
+	if (helpers) {
+		_helper_wakeup.notify_all();
+	}
+}
+
+void WorkStealingPool::wait() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	_all_done.wait(lock, [this] { return _unfinished == 0; });
+}
+
+void WorkStealingPool::help_until(const std::function<bool()>& done) {
+	unsigned index = current_pool == this ? current_worker : 0;
+	
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			
+			_helpers++;
+			_helper_wakeup.wait(lock, [&] { return done() or _queued > 0; });
+			_helpers--;
+			
+			if (done()) {
+				return;
+			}
+			
+			_queued--;
+		}
+		
+		std::function<void()> task;
+		
+		while (!take_task(index, task)) {
+			std::this_thread::yield();
+		}
+		
+		task();
+		finish_task();
+	}
+}
+
+unsigned WorkStealingPool::thread_count() const {
+	return _threads.size();
+}
+
+void WorkStealingPool::run(unsigned index) {
+	current_pool = this;
+	current_worker = index;
+	
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_task_queued.wait(lock, [this] { return _stopping or _queued > 0; });
+			
+			if (_queued == 0) {
+				return;
+			}
+			
+			// Claims one of the queued tasks; it is guaranteed to be found
+			// below, though possibly in another worker's queue.
+			_queued--;
+		}
+		
+		std::function<void()> task;
+		
+		while (!take_task(index, task)) {
+			std::this_thread::yield();
+		}
+		
+		task();
+		finish_task();
+	}
+}
+
+void WorkStealingPool::finish_task() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	
+	if (--_unfinished == 0) {
+		_all_done.notify_all();
+	}
+	
+	if (_helpers > 0) {
+		_helper_wakeup.notify_all();
+	}
+}
+
+bool WorkStealingPool::take_task(unsigned index, std::function<void()>& task) {
+	{
+		Queue& own = *_queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+	
+	for (size_t i = 1; i < _queues.size(); i++) {
+		Queue& victim = *_queues[(index + i) % _queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+	
+	return false;
+}
+
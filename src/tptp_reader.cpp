@@ -0,0 +1,776 @@
+#include <cstdlib>
+#include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+
+#include "tptp_reader.hpp"
+#include "problem_reader.hpp"
+#include "mapped_file.hpp"
+#include "atom.hpp"
+#include "connective.hpp"
+#include "quantifier.hpp"
+#include "node_factory.hpp"
+
+namespace {
+
+enum class TptpToken {
+	End,
+	LowerWord,
+	UpperWord,
+	DollarWord,
+	SingleQuoted,
+	DistinctObject,
+	Number,
+	LeftParenthesis,
+	RightParenthesis,
+	LeftBracket,
+	RightBracket,
+	Comma,
+	Dot,
+	Colon,
+	ForAll,
+	Exists,
+	Not,
+	And,
+	Or,
+	Iff,
+	Implies,
+	ReverseImplies,
+	Xor,
+	Nor,
+	Nand,
+	Equal,
+	NotEqual,
+	Other
+};
+
+const unsigned max_nesting = 10000;
+const unsigned max_include_depth = 64;
+
+struct ParseError {
+	size_t offset;
+	std::string message;
+};
+
+// One top-level input of a TPTP file: an annotated formula or an include.
+struct TptpInput {
+	bool is_include = false;
+	TptpFormula formula;
+	std::string include_path;
+	std::vector<std::string> selection;
+};
+
+class TptpParser {
+	public:
+		TptpParser(std::string_view input)
+			:_input(input)
+		{
+			next();
+		}
+		
+		// Returns false at the end of the input.
+		bool read(TptpInput& input) {
+			if (_token == TptpToken::End) {
+				return false;
+			}
+			
+			expect(TptpToken::LowerWord, "expected fof, cnf or include");
+			std::string_view kind = _text;
+			next();
+			expect_and_skip(TptpToken::LeftParenthesis, "expected '('");
+			
+			if (kind == "include") {
+				read_include(input);
+			} else if (kind == "fof" or kind == "cnf") {
+				read_annotated_formula(input, kind == "cnf");
+			} else {
+				throw ParseError{_token_start, "unsupported input " + std::string(kind)};
+			}
+			
+			expect_and_skip(TptpToken::RightParenthesis, "expected ')'");
+			expect_and_skip(TptpToken::Dot, "expected '.'");
+			
+			return true;
+		}
+		
+		size_t line_of(size_t offset) const {
+			return std::count(_input.begin(), _input.begin() + std::min(offset, _input.size()), '\n') + 1;
+		}
+	private:
+		static bool is_alphanumeric(char c) {
+			return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or (c >= '0' and c <= '9') or c == '_';
+		}
+		
+		static bool is_digit(char c) {
+			return c >= '0' and c <= '9';
+		}
+		
+		char peek(size_t ahead = 0) const {
+			return _position + ahead < _input.size() ? _input[_position + ahead] : '\0';
+		}
+		
+		void skip_whitespace_and_comments() {
+			while (_position < _input.size()) {
+				char c = _input[_position];
+				
+				if (c == ' ' or c == '\t' or c == '\n' or c == '\r' or c == '\f' or c == '\v') {
+					_position++;
+				} else if (c == '%') {
+					size_t end = _input.find('\n', _position);
+					_position = end == std::string_view::npos ? _input.size() : end;
+				} else if (c == '/' and peek(1) == '*') {
+					size_t end = _input.find("*/", _position + 2);
+					
+					if (end == std::string_view::npos) {
+						throw ParseError{_position, "unterminated comment"};
+					}
+					
+					_position = end + 2;
+				} else {
+					return;
+				}
+			}
+		}
+		
+		void read_word() {
+			while (_position < _input.size() and is_alphanumeric(_input[_position])) {
+				_position++;
+			}
+		}
+		
+		void read_quoted(char quote) {
+			_position++;
+			
+			while (_position < _input.size() and _input[_position] != quote) {
+				_position += _input[_position] == '\\' ? 2 : 1;
+			}
+			
+			if (_position >= _input.size()) {
+				throw ParseError{_token_start, "unterminated quoted name"};
+			}
+			
+			_position++;
+		}
+		
+		void read_number() {
+			if (peek() == '+' or peek() == '-') {
+				_position++;
+			}
+			
+			while (is_digit(peek())) {
+				_position++;
+			}
+			
+			if ((peek() == '.' or peek() == '/') and is_digit(peek(1))) {
+				_position++;
+				
+				while (is_digit(peek())) {
+					_position++;
+				}
+			}
+			
+			if ((peek() == 'e' or peek() == 'E') and (is_digit(peek(1)) or ((peek(1) == '+' or peek(1) == '-') and is_digit(peek(2))))) {
+				_position += 2;
+				
+				while (is_digit(peek())) {
+					_position++;
+				}
+			}
+		}
+		
+		// Sets _token to the next token and _text to its spelling.
+		void next() {
+			skip_whitespace_and_comments();
+			
+			_token_start = _position;
+			_token = lex();
+			_text = _input.substr(_token_start, _position - _token_start);
+		}
+		
+		TptpToken lex() {
+			if (_position == _input.size()) {
+				return TptpToken::End;
+			}
+			
+			char c = _input[_position];
+			
+			if (c >= 'a' and c <= 'z') {
+				read_word();
+				return TptpToken::LowerWord;
+			}
+			
+			if (c >= 'A' and c <= 'Z') {
+				read_word();
+				return TptpToken::UpperWord;
+			}
+			
+			if (c == '$') {
+				_position += peek(1) == '$' ? 2 : 1;
+				read_word();
+				return TptpToken::DollarWord;
+			}
+			
+			if (c == '\'') {
+				read_quoted('\'');
+				return TptpToken::SingleQuoted;
+			}
+			
+			if (c == '"') {
+				read_quoted('"');
+				return TptpToken::DistinctObject;
+			}
+			
+			if (is_digit(c) or ((c == '+' or c == '-') and is_digit(peek(1)))) {
+				read_number();
+				return TptpToken::Number;
+			}
+			
+			_position++;
+			
+			switch (c) {
+				case '(':
+					return TptpToken::LeftParenthesis;
+				case ')':
+					return TptpToken::RightParenthesis;
+				case '[':
+					return TptpToken::LeftBracket;
+				case ']':
+					return TptpToken::RightBracket;
+				case ',':
+					return TptpToken::Comma;
+				case '.':
+					return TptpToken::Dot;
+				case ':':
+					return TptpToken::Colon;
+				case '?':
+					return TptpToken::Exists;
+				case '&':
+					return TptpToken::And;
+				case '|':
+					return TptpToken::Or;
+				case '!':
+					return skip_if('=') ? TptpToken::NotEqual : TptpToken::ForAll;
+				case '~':
+					if (skip_if('|')) {
+						return TptpToken::Nor;
+					}
+					
+					return skip_if('&') ? TptpToken::Nand : TptpToken::Not;
+				case '=':
+					return skip_if('>') ? TptpToken::Implies : TptpToken::Equal;
+				case '<':
+					if (peek() == '=' and peek(1) == '>') {
+						_position += 2;
+						return TptpToken::Iff;
+					}
+					
+					if (peek() == '~' and peek(1) == '>') {
+						_position += 2;
+						return TptpToken::Xor;
+					}
+					
+					return skip_if('=') ? TptpToken::ReverseImplies : TptpToken::Other;
+				default:
+					return TptpToken::Other;
+			}
+		}
+		
+		bool skip_if(char c) {
+			if (peek() == c) {
+				_position++;
+				return true;
+			}
+			
+			return false;
+		}
+		
+		void expect(TptpToken token, const std::string& message) const {
+			if (_token != token) {
+				throw ParseError{_token_start, message};
+			}
+		}
+		
+		void expect_and_skip(TptpToken token, const std::string& message) {
+			expect(token, message);
+			next();
+		}
+		
+		void enter() {
+			if (++_nesting > max_nesting) {
+				throw ParseError{_token_start, "formula nested too deeply"};
+			}
+		}
+		
+		void leave() {
+			_nesting--;
+		}
+		
+		// 'abc' and abc are the same name, so quotes are only kept where they
+		// are needed.
+		std::string name_text() const {
+			if (_token != TptpToken::SingleQuoted) {
+				return std::string(_text);
+			}
+			
+			std::string_view content = _text.substr(1, _text.size() - 2);
+			
+			bool plain = !content.empty() and content[0] >= 'a' and content[0] <= 'z' and std::all_of(content.begin(), content.end(), is_alphanumeric);
+			
+			return plain ? std::string(content) : std::string(_text);
+		}
+		
+		std::string read_name() {
+			if (_token != TptpToken::LowerWord and _token != TptpToken::SingleQuoted and _token != TptpToken::Number) {
+				throw ParseError{_token_start, "expected a name"};
+			}
+			
+			std::string name = name_text();
+			next();
+			return name;
+		}
+		
+		// include('path'[, [name, ...]]) after the opening parenthesis.
+		void read_include(TptpInput& input) {
+			expect(TptpToken::SingleQuoted, "expected a quoted file name");
+			
+			input.is_include = true;
+			input.include_path = std::string(_text.substr(1, _text.size() - 2));
+			input.selection.clear();
+			next();
+			
+			if (_token != TptpToken::Comma) {
+				return;
+			}
+			
+			next();
+			expect_and_skip(TptpToken::LeftBracket, "expected '['");
+			
+			if (_token != TptpToken::RightBracket) {
+				input.selection.push_back(read_name());
+				
+				while (_token == TptpToken::Comma) {
+					next();
+					input.selection.push_back(read_name());
+				}
+			}
+			
+			expect_and_skip(TptpToken::RightBracket, "expected ']'");
+		}
+		
+		// fof(name, role, formula[, source[, info]]) after the opening parenthesis.
+		void read_annotated_formula(TptpInput& input, bool clause) {
+			input.is_include = false;
+			input.formula.name = read_name();
+			expect_and_skip(TptpToken::Comma, "expected ','");
+			expect(TptpToken::LowerWord, "expected a role");
+			input.formula.role = std::string(_text);
+			next();
+			expect_and_skip(TptpToken::Comma, "expected ','");
+			
+			std::shared_ptr<Formula> formula = logic_formula();
+			
+			if (clause) {
+				VariableSet variables = formula->get_free_variable_names();
+				
+				for (auto it = variables.end(); it != variables.begin();) {
+					--it;
+					formula = NodeFactory::make_for_all(*it, formula);
+				}
+			}
+			
+			input.formula.formula = formula;
+			
+			if (_token == TptpToken::Comma) {
+				skip_annotations();
+			}
+		}
+		
+		// Sources and useful info are arbitrary nested terms and lists.
+		void skip_annotations() {
+			unsigned depth = 0;
+			
+			while (depth > 0 or _token != TptpToken::RightParenthesis) {
+				if (_token == TptpToken::End) {
+					throw ParseError{_token_start, "unterminated annotations"};
+				}
+				
+				if (_token == TptpToken::LeftParenthesis or _token == TptpToken::LeftBracket) {
+					depth++;
+				} else if (_token == TptpToken::RightParenthesis or _token == TptpToken::RightBracket) {
+					depth--;
+				}
+				
+				next();
+			}
+		}
+		
+		static bool is_binary_connective(TptpToken token) {
+			switch (token) {
+				case TptpToken::Iff:
+				case TptpToken::Implies:
+				case TptpToken::ReverseImplies:
+				case TptpToken::Xor:
+				case TptpToken::Nor:
+				case TptpToken::Nand:
+				case TptpToken::And:
+				case TptpToken::Or:
+					return true;
+				default:
+					return false;
+			}
+		}
+		
+		// Either a chain of one associative connective (& or |) or a single
+		// non-associative one. Mixing them needs parentheses.
+		std::shared_ptr<Formula> logic_formula() {
+			std::shared_ptr<Formula> left = unitary_formula();
+			TptpToken connective = _token;
+			
+			if (!is_binary_connective(connective)) {
+				return left;
+			}
+			
+			std::shared_ptr<Formula> formula;
+			
+			if (connective == TptpToken::And or connective == TptpToken::Or) {
+				std::vector<std::shared_ptr<Formula>> operands = {left};
+				
+				while (_token == connective) {
+					next();
+					operands.push_back(unitary_formula());
+				}
+				
+				formula = operands.back();
+				
+				for (size_t i = operands.size() - 1; i > 0; i--) {
+					if (connective == TptpToken::And) {
+						formula = NodeFactory::make_conjunction(operands[i - 1], formula);
+					} else {
+						formula = NodeFactory::make_disjunction(operands[i - 1], formula);
+					}
+				}
+			} else {
+				next();
+				formula = binary_formula(connective, left, unitary_formula());
+			}
+			
+			if (is_binary_connective(_token)) {
+				throw ParseError{_token_start, "connectives of different kinds need parentheses"};
+			}
+			
+			return formula;
+		}
+		
+		static std::shared_ptr<Formula> binary_formula(TptpToken connective, const std::shared_ptr<Formula>& l, const std::shared_ptr<Formula>& r) {
+			switch (connective) {
+				case TptpToken::Iff:
+					return NodeFactory::make_equivalence(l, r);
+				case TptpToken::Implies:
+					return NodeFactory::make_implication(l, r);
+				case TptpToken::ReverseImplies:
+					return NodeFactory::make_implication(r, l);
+				case TptpToken::Xor:
+					return NodeFactory::make_negation(NodeFactory::make_equivalence(l, r));
+				case TptpToken::Nor:
+					return NodeFactory::make_negation(NodeFactory::make_disjunction(l, r));
+				default:
+					return NodeFactory::make_negation(NodeFactory::make_conjunction(l, r));
+			}
+		}
+		
+		std::shared_ptr<Formula> unitary_formula() {
+			enter();
+			
+			std::shared_ptr<Formula> formula;
+			
+			if (_token == TptpToken::ForAll or _token == TptpToken::Exists) {
+				formula = quantified_formula();
+			} else if (_token == TptpToken::Not) {
+				next();
+				formula = NodeFactory::make_negation(unitary_formula());
+			} else if (_token == TptpToken::LeftParenthesis) {
+				next();
+				formula = logic_formula();
+				expect_and_skip(TptpToken::RightParenthesis, "expected ')'");
+			} else {
+				formula = atomic_formula();
+			}
+			
+			leave();
+			
+			return formula;
+		}
+		
+		// ! [X, Y] : formula
+		std::shared_ptr<Formula> quantified_formula() {
+			bool for_all = _token == TptpToken::ForAll;
+			next();
+			expect_and_skip(TptpToken::LeftBracket, "expected '['");
+			
+			std::vector<Symbol> variables;
+			
+			while (true) {
+				expect(TptpToken::UpperWord, "expected a variable");
+				variables.push_back(Symbol(std::string(_text)));
+				next();
+				
+				if (_token != TptpToken::Comma) {
+					break;
+				}
+				
+				next();
+			}
+			
+			expect_and_skip(TptpToken::RightBracket, "expected ']'");
+			expect_and_skip(TptpToken::Colon, "expected ':'");
+			
+			std::shared_ptr<Formula> formula = unitary_formula();
+			
+			for (auto it = variables.rbegin(); it != variables.rend(); ++it) {
+				if (for_all) {
+					formula = NodeFactory::make_for_all(*it, formula);
+				} else {
+					formula = NodeFactory::make_exists(*it, formula);
+				}
+			}
+			
+			return formula;
+		}
+		
+		std::shared_ptr<Formula> atomic_formula() {
+			if (_token == TptpToken::UpperWord) {
+				return equation(term());
+			}
+			
+			bool defined = _token == TptpToken::DollarWord;
+			std::string_view text = _text;
+			
+			Symbol symbol = functor();
+			std::vector<std::shared_ptr<Term>> arguments = arguments_if_any();
+			
+			if (_token == TptpToken::Equal or _token == TptpToken::NotEqual) {
+				return equation(make_term(symbol, arguments));
+			}
+			
+			if (defined and arguments.empty() and text == "$true") {
+				return NodeFactory::make_true();
+			}
+			
+			if (defined and arguments.empty() and text == "$false") {
+				return NodeFactory::make_false();
+			}
+			
+			if (arguments.empty()) {
+				return NodeFactory::make_simple_atom(symbol);
+			}
+			
+			return NodeFactory::make_complex_atom(symbol, arguments);
+		}
+		
+		std::shared_ptr<Formula> equation(const std::shared_ptr<Term>& left) {
+			if (_token != TptpToken::Equal and _token != TptpToken::NotEqual) {
+				throw ParseError{_token_start, "expected '=' or '!='"};
+			}
+			
+			bool negated = _token == TptpToken::NotEqual;
+			next();
+			
+			std::shared_ptr<Formula> atom = NodeFactory::make_complex_atom(Symbol("="), {left, term()});
+			
+			if (negated) {
+				return NodeFactory::make_negation(atom);
+			}
+			
+			return atom;
+		}
+		
+		Symbol functor() {
+			switch (_token) {
+				case TptpToken::LowerWord:
+				case TptpToken::DollarWord:
+				case TptpToken::SingleQuoted:
+				case TptpToken::DistinctObject:
+				case TptpToken::Number: {
+					Symbol symbol(name_text());
+					next();
+					return symbol;
+				}
+				default:
+					throw ParseError{_token_start, "expected a formula or term"};
+			}
+		}
+		
+		std::vector<std::shared_ptr<Term>> arguments_if_any() {
+			std::vector<std::shared_ptr<Term>> arguments;
+			
+			if (_token != TptpToken::LeftParenthesis) {
+				return arguments;
+			}
+			
+			enter();
+			next();
+			arguments.push_back(term());
+			
+			while (_token == TptpToken::Comma) {
+				next();
+				arguments.push_back(term());
+			}
+			
+			expect_and_skip(TptpToken::RightParenthesis, "expected ')'");
+			leave();
+			
+			return arguments;
+		}
+		
+		static std::shared_ptr<Term> make_term(const Symbol& symbol, const std::vector<std::shared_ptr<Term>>& arguments) {
+			if (arguments.empty()) {
+				return NodeFactory::make_constant(symbol);
+			}
+			
+			return NodeFactory::make_complex_term(symbol, arguments);
+		}
+		
+		std::shared_ptr<Term> term() {
+			if (_token == TptpToken::UpperWord) {
+				Symbol variable{std::string(_text)};
+				next();
+				return NodeFactory::make_variable(variable);
+			}
+			
+			Symbol symbol = functor();
+			return make_term(symbol, arguments_if_any());
+		}
+	private:
+		std::string_view _input;
+		size_t _position = 0;
+		size_t _token_start = 0;
+		TptpToken _token = TptpToken::End;
+		std::string_view _text;
+		unsigned _nesting = 0;
+};
+
+std::string resolve_include(const std::string& include, const std::string& including_file) {
+	namespace fs = std::filesystem;
+	
+	if (fs::path(include).is_absolute()) {
+		return include;
+	}
+	
+	for (fs::path directory = fs::path(including_file).parent_path();; directory = directory.parent_path()) {
+		fs::path candidate = directory / include;
+		
+		if (fs::exists(candidate)) {
+			return candidate.string();
+		}
+		
+		if (directory.empty() or directory == directory.parent_path()) {
+			break;
+		}
+	}
+	
+	if (const char* root = std::getenv("TPTP")) {
+		fs::path candidate = fs::path(root) / include;
+		
+		if (fs::exists(candidate)) {
+			return candidate.string();
+		}
+	}
+	
+	throw std::runtime_error(including_file + ": cannot find included file " + include);
+}
+
+}
+
+TptpProblem TptpReader::read(const std::string& filename) {
+	TptpProblem problem;
+	load(filename, 0, problem.formulas, problem.bytes_read);
+	return problem;
+}
+
+void TptpReader::load(const std::string& filename, unsigned depth, std::vector<TptpFormula>& formulas, size_t& bytes_read) {
+	if (depth > max_include_depth) {
+		throw std::runtime_error(filename + ": includes nested too deeply");
+	}
+	
+	MappedFile file(filename);
+	bytes_read += file.contents().size();
+	
+	TptpParser parser(file.contents());
+	TptpInput input;
+	
+	while (true) {
+		try {
+			if (!parser.read(input)) {
+				break;
+			}
+		} catch (const ParseError& e) {
+			throw std::runtime_error(filename + ":" + std::to_string(parser.line_of(e.offset)) + ": " + e.message);
+		}
+		
+		if (!input.is_include) {
+			formulas.push_back(input.formula);
+			continue;
+		}
+		
+		auto included_formulas = included(resolve_include(input.include_path, filename), depth + 1, bytes_read);
+		const std::vector<std::string>& selection = input.selection;
+		
+		for (const auto& formula : *included_formulas) {
+			if (selection.empty() or std::find(selection.begin(), selection.end(), formula.name) != selection.end()) {
+				formulas.push_back(formula);
+			}
+		}
+	}
+}
+
+std::shared_ptr<const std::vector<TptpFormula>> TptpReader::included(const std::string& filename, unsigned depth, size_t& bytes_read) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		
+		auto it = _included.find(filename);
+		
+		if (it != _included.end()) {
+			return it->second;
+		}
+	}
+	
+	// Parsed without holding the lock; if another thread got here first,
+	// its result is kept and this one dropped.
+	auto formulas = std::make_shared<std::vector<TptpFormula>>();
+	load(filename, depth, *formulas, bytes_read);
+	
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _included.emplace(filename, formulas).first->second;
+}
+
+TptpProblem read_tptp_problem(const std::string& filename) {
+	return TptpReader().read(filename);
+}
+
+std::shared_ptr<Formula> read_tptp_goal(const std::string& filename, const std::string& conjecture_name) {
+	TptpProblem problem = read_tptp_problem(filename);
+	
+	std::vector<std::shared_ptr<Formula>> premises;
+	std::shared_ptr<Formula> conjecture;
+	
+	for (const auto& entry : problem.formulas) {
+		bool selected = conjecture_name.empty() ? entry.role == "conjecture" : entry.name == conjecture_name;
+		
+		if (selected) {
+			if (conjecture) {
+				throw std::runtime_error(filename + ": more than one conjecture");
+			}
+			
+			conjecture = entry.formula;
+		} else if (is_premise_role(entry.role)) {
+			premises.push_back(entry.formula);
+		}
+	}
+	
+	if (!conjecture) {
+		throw std::runtime_error(filename + (conjecture_name.empty() ? ": no conjecture" : ": no entry named " + conjecture_name));
+	}
+	
+	return make_problem_goal(premises, conjecture);
+}
+